@@ -9,3 +9,10 @@ class FakeBridge:
 
     def __setitem__(self, key, value):
         self._data[key] = value
+
+    def read_range(self, key, count):
+        return [self[k] for k in range(key, key + count)]
+
+    def write_range(self, key, values):
+        for offset, value in enumerate(values):
+            self[key + offset] = value
@@ -5,13 +5,17 @@ from adafruit_bus_device.i2c_device import I2CDevice
 
 REGISTER_READ = 0
 REGISTER_WRITE = 1
+REGISTER_READ_RANGE = 2
+REGISTER_WRITE_RANGE = 3
 
 class I2cBridge:
     def __init__(self, i2c):
         self._device = I2CDevice(i2c, 0x69)
 
     def _transfer(self, command, key, value):
-        request = struct.pack("<BHH", command, key, value)
+        return self._transfer_request(struct.pack("<BHH", command, key, value))
+
+    def _transfer_request(self, request):
         response = bytearray([0] * 3)
         with self._device:
             self._device.write_then_readinto(request, response)
@@ -21,6 +25,26 @@ class I2cBridge:
         else:
             return None
 
+    def read_range(self, key, count):
+        request = struct.pack("<BHH", REGISTER_READ_RANGE, key, count)
+        response = bytearray(1 + 2 * count)
+        with self._device:
+            self._device.write_then_readinto(request, response)
+        success, *values = struct.unpack(f"<B{count}H", response)
+        if success:
+            return values
+        else:
+            return None
+
+    def write_range(self, key, values):
+        count = len(values)
+        request = struct.pack(
+            f"<BHH{count}H", REGISTER_WRITE_RANGE, key, count, *values
+        )
+        written_count = self._transfer_request(request)
+        if written_count != count:
+            raise RuntimeError("unknown write failure")
+
     def __getitem__(self, key):
         return self._transfer(REGISTER_READ, key, value=0)
 
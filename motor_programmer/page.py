@@ -22,3 +22,14 @@ class Page:
 
     def absolute_key(self, key):
         return self.start + (key % len(self))
+
+    # All values of the page, loaded in one transaction.
+    def values(self):
+        return self.params.read_range(self.start, self.stop)
+
+    # Caches the whole page so that browsing it doesn't touch the drive.
+    def prefetch(self):
+        self.params.prefetch(self.start, self.stop)
+
+    def invalidate(self):
+        self.params.invalidate(self.start, self.stop)
@@ -3,6 +3,8 @@ from page import Page
 class Parameters:
     def __init__(self, bridge_device):
         self._device = bridge_device
+        # Last known drive value of each register, keyed by absolute key.
+        self._cache = {}
         starts = (0, 25, 65, 95, 125, 175, 215, 255)
         lengths = (20, 38, 24, 25, 48, 36, 34, 17)
         self._pages = []
@@ -18,12 +20,55 @@ class Parameters:
 
     def __getitem__(self, key):
         key = self._check_key(key)
-        return self._device[key]
+        if key not in self._cache:
+            value = self._device[key]
+            if value is None:
+                raise RuntimeError(f"Failed to read {key}")
+            self._cache[key] = value
+        return self._cache[key]
 
+    # Writes through to the drive, and reads the value back to verify it.
     def __setitem__(self, key, value):
         key = self._check_key(key)
+        self._cache.pop(key, None)
         self._device[key] = value
+        written_value = self._device[key]
+        if written_value != value:
+            raise RuntimeError(
+                f"Wrote {value} to {key} but read back {written_value}"
+            )
+        self._cache[key] = written_value
 
+    # Reads registers [start, stop) in a single bridge transaction. The range
+    # must not wrap around.
+    def read_range(self, start, stop):
+        start = self._check_key(start)
+        values = self._device.read_range(start, stop - start)
+        if values is None:
+            raise RuntimeError(f"Failed to read {start} to {stop}")
+        for key, value in enumerate(values, start):
+            self._cache[key] = value
+        return values
+
+    def write_range(self, start, values):
+        start = self._check_key(start)
+        self.invalidate(start, start + len(values))
+        self._device.write_range(start, values)
+
+    # Loads registers [start, stop) into the cache in a single transaction,
+    # unless they're all cached already.
+    def prefetch(self, start, stop):
+        if all(key in self._cache for key in range(start, stop)):
+            return
+        self.read_range(start, stop)
+
+    # Forgets cached registers [start, stop), or all of them by default, so
+    # that they're read from the drive on next access.
+    def invalidate(self, start=0, stop=None):
+        if stop is None:
+            stop = len(self)
+        for key in range(start, stop):
+            self._cache.pop(key, None)
 
     def _check_key(self, key):
         if int(key) != key:
@@ -157,6 +157,7 @@ class Ui:
         new_value.y = value.anchored_position[1] + value.height
         self._new_value_editor = new_value
 
+        self.page.prefetch()
         self._reset_key_value_text()
 
     @property
@@ -190,6 +191,7 @@ class Ui:
             self._offset = 0
             self._page_index += page_delta
             self._page_index %= len(self._params.pages)
+            self.page.prefetch()
         self._reset_key_value_text()
         self.render()
 
@@ -199,7 +201,11 @@ class Ui:
     def next_digit(self):
         self._new_value_editor.next_digit()
 
+    # Discards the edit, and refreshes the page from the drive in case it was
+    # changed from elsewhere.
     def cancel(self):
+        self.page.invalidate()
+        self.page.prefetch()
         self._reset_key_value_text()
 
     def confirm(self):
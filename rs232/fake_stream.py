@@ -16,15 +16,20 @@ class FakeStream:
         self._last_request = None
         if not last_request:
             return None
-        parts = struct.unpack(">BBHHBB", last_request)
-        function = parts[1]
+        address, function, key = struct.unpack_from(">BBH", last_request)
         if function == 3:
-            key = parts[2]
-            value = self._data.get(key, 1000 + key)
-            payload = struct.pack(">BBBH", 63, 3, 2, value)
+            (count,) = struct.unpack_from(">H", last_request, 4)
+            values = [self._data.get(k, 1000 + k) for k in range(key, key + count)]
+            payload = struct.pack(f">BBB{count}H", 63, 3, 2 * count, *values)
             return payload + crc.checksum_bytes(payload)
         if function == 6:
-            key = parts[2]
-            value = parts[3]
+            (value,) = struct.unpack_from(">H", last_request, 4)
             self._data[key] = value
             return last_request
+        if function == 16:
+            count, byte_count = struct.unpack_from(">HB", last_request, 4)
+            values = struct.unpack_from(f">{count}H", last_request, 7)
+            for offset, value in enumerate(values):
+                self._data[key + offset] = value
+            payload = last_request[:6]
+            return payload + crc.checksum_bytes(payload)
@@ -40,6 +40,10 @@ class Modbus:
         return struct.unpack(format, payload)
 
     def get(self, key):
+        (value,) = self.get_range(key, 1)
+        return value
+
+    def get_range(self, key, count):
         read_command = struct.pack(
             ">BBHH",
             # Address
@@ -49,11 +53,11 @@ class Modbus:
             # Offset
             key,
             # Count
-            1,
+            count,
         )
         self._send(read_command)
-        address, function, byte_count, value = self._recv(">BBBH")
-        return value
+        address, function, byte_count, *values = self._recv(f">BBB{count}H")
+        return values
 
     def set(self, key, value):
         write_command = struct.pack(
@@ -73,3 +77,26 @@ class Modbus:
             raise ValueError(
                 f"Expected response: {list(write_command)} Actual response: {list(write_response)}"
             )
+
+    def set_range(self, key, values):
+        count = len(values)
+        write_command = struct.pack(
+            f">BBHHB{count}H",
+            # Address
+            63,
+            # Write multiple holding registers
+            16,
+            # Offset
+            key,
+            # Count
+            count,
+            # Byte count
+            2 * count,
+            *values,
+        )
+        self._send(write_command)
+        (write_response,) = self._recv(">6s")
+        if write_response != write_command[:6]:
+            raise ValueError(
+                f"Expected response: {list(write_command[:6])} Actual response: {list(write_response)}"
+            )
@@ -4,6 +4,12 @@ from collections import namedtuple
 
 REGISTER_READ = 0
 REGISTER_WRITE = 1
+# The value field carries the register count. Range writes append the values
+# to the request, range reads append them to the response.
+REGISTER_READ_RANGE = 2
+REGISTER_WRITE_RANGE = 3
+
+HEADER_SIZE = 5
 
 Request = namedtuple('Request', ['command', 'value', 'offset'])
 
@@ -33,16 +39,31 @@ class Target:
         # Device -> Controller
         head = self._buffered_input
         self._buffered_input = bytearray()
-        if len(head) != 5:
+        if len(head) < HEADER_SIZE:
             print(f'Ignoring malformed message: {list(head)}')
             return
         print(f'Servicing read for request: {list(head)}')
-        command, offset, value = struct.unpack('<BHH', head)
+        command, offset, value = struct.unpack_from('<BHH', head)
+        expected_size = HEADER_SIZE
+        if command == REGISTER_WRITE_RANGE:
+            expected_size += 2 * value
+        if len(head) != expected_size:
+            print(f'Ignoring malformed message: {list(head)}')
+            return
+        success = True
+        values = None
         if command == REGISTER_READ:
             value = self._modbus.get(offset)
         elif command == REGISTER_WRITE:
             self._modbus.set(offset, value)
-        success = True
-        response = struct.pack('<BH', success, value)
+        elif command == REGISTER_READ_RANGE:
+            values = self._modbus.get_range(offset, value)
+        elif command == REGISTER_WRITE_RANGE:
+            self._modbus.set_range(
+                offset, struct.unpack_from(f'<{value}H', head, HEADER_SIZE))
+        if values is None:
+            response = struct.pack('<BH', success, value)
+        else:
+            response = struct.pack(f'<B{len(values)}H', success, *values)
         print(f"Responding to read request with: {list(response)}")
         request.write(response)
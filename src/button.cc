@@ -1,6 +1,7 @@
 #include "button.h"
 
 #include <hardware/gpio.h>
+#include <hardware/timer.h>
 
 #include <cstdint>
 
@@ -16,11 +17,15 @@ void Button::State::Init(irq_handler_t edge_interrupt_handler) {
 }
 
 void Button::State::HandleInterrupt() {
-  auto events = gpio_get_irq_event_mask(pin);
-  if ((events & kPinEventMask) == 0) {
+  const auto pin_events = gpio_get_irq_event_mask(pin);
+  if ((pin_events & kPinEventMask) == 0) {
     return;
   }
   gpio_acknowledge_irq(pin, kPinEventMask);
   const bool value = !gpio_get(pin);
-  waiter->Send(value);
+  if (value == pressed) {
+    return;
+  }
+  pressed = value;
+  events->Push({.pressed = value, .time_us = time_us_64()});
 }
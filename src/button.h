@@ -1,85 +1,47 @@
 #pragma once
 
-#include <coroutine>
+#include <cstdint>
 #include <optional>
-#include <utility>
+#include <type_traits>
 
-#include "picopp/critical_section.h"
 #include "picopp/irq.h"
-#include "picoro/async.h"
 #include "picoro/awaitable_reference.h"
+#include "picoro/event_queue.h"
 
 class Button {
  public:
+  struct Event {
+    // True if the button was pressed, false if released.
+    bool pressed;
+    std::uint64_t time_us;
+  };
+
+  // Holds more press/release pairs than can plausibly arrive between two
+  // resumptions of the awaiting coroutine; any beyond that are dropped.
+  static constexpr std::size_t kMaxEvents = 8;
+  using Events = EventQueue<Event, kMaxEvents>;
+
   template <unsigned pin>
   static Button Create(async_context_t& context);
 
   void operator=(const Button&) = delete;
 
-  // Awaits an update to the button state; returns true if the button is being
-  // pressed, and false if the button is released.
+  // Awaits changes to the button state; resumes with an Events::Batch of all
+  // presses and releases since the last resumption, oldest first.
   auto operator co_await();
 
  private:
   struct State;
-  class Waiter;
 
   Button(State* state) : state_(state) {}
   State* state_;
 };
 
-class Button::Waiter {
- public:
-  Waiter(async_context_t& context) : executor_(context) {}
-
-  bool await_ready() {
-    CriticalSectionLock lock(mutex_);
-    return value_.has_value();
-  }
-
-  bool await_suspend(std::coroutine_handle<> handle) {
-    CriticalSectionLock lock(mutex_);
-    if (value_.has_value()) {
-      // Racing update between await_ready() and await_suspend().
-      return false;
-    }
-    pending_ = handle;
-    return true;
-  }
-
-  bool await_resume() {
-    CriticalSectionLock lock(mutex_);
-    const bool value = *value_;
-    value_.reset();
-    return value;
-  }
-
-  void Send(bool value) {
-    std::coroutine_handle<> pending;
-    {
-      CriticalSectionLock lock(mutex_);
-      if (value == value_) {
-        return;
-      }
-      value_ = value;
-      std::swap(pending, pending_);
-    }
-    if (pending) {
-      executor_.Schedule(pending);
-    }
-  }
-
- private:
-  AsyncExecutor executor_;
-
-  CriticalSection mutex_;
-  std::optional<bool> value_;
-  std::coroutine_handle<> pending_;
-};
-
 struct Button::State {
   unsigned pin;
-  std::optional<Waiter> waiter;
+  // Last state reported, to filter out repeated edges.
+  bool pressed = false;
+  std::optional<Events> events;
 
   void Init(irq_handler_t edge_interrupt_handler);
 
@@ -93,12 +55,12 @@ Button Button::Create(async_context_t& context) {
 
   State& state = Singleton::state;
   state.pin = pin;
-  state.waiter.emplace(context);
+  state.events.emplace(context);
   state.Init(Singleton::interrupt_handler);
 
   return Button(&state);
 }
 
 inline auto Button::operator co_await() {
-  return AwaitableReference(*state_->waiter);
+  return AwaitableReference(*state_->events);
 }
@@ -0,0 +1,405 @@
+#pragma once
+
+#include <hardware/timer.h>
+#include <pico/async_context.h>
+#include <pico/stdlib.h>
+#include <pico/time.h>
+
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+#include "button.h"
+#include "fixed_exp2.h"
+#include "font/font.h"
+#include "oled.h"
+#include "picopp/gpio.h"
+#include "picoro/async.h"
+#include "picoro/event.h"
+#include "picoro/mailbox.h"
+#include "picoro/task.h"
+#include "probe.h"
+#include "ramp.h"
+#include "readout.h"
+#include "rotary_encoder.h"
+#include "speed_control.h"
+#include "trace.h"
+
+// Top-level power feed application: reads the encoders and direction switch,
+// drives the feed motor, and renders the speed readout.
+//
+// The encoders, direction switch and motor ramp run on `motion_context`, which
+// main() polls on core 1, so that rendering and logging on `context` can't
+// delay step rate updates. The motion side posts each new setpoint to the
+// other through `setpoint`, which is all they share once running.
+struct Controller {
+  // What the display shows.
+  struct Setpoint {
+    std::int64_t level = 0;
+    int direction = 0;
+
+    bool operator==(const Setpoint&) const = default;
+  };
+
+  async_context_t& context;
+  async_context_t& motion_context;
+  Oled oled;
+  OledBuffer& buffer;
+  RotaryEncoder encoders[3];
+  Button buttons[3];
+  Gpio left_button;
+  Gpio right_button;
+  SpeedControl speed_control;
+  Ramp ramp;
+  // Shared by the tasks that sleep on each context; one slot each.
+  MultiAsyncExecutor<3> executor;
+  MultiAsyncExecutor<2> motion_executor;
+  // Notified on the motion context whenever the requested speed or direction
+  // changes.
+  Broadcast changed;
+  Mailbox<Setpoint> setpoint;
+  // Pre-rendered fixed images for UpdateTask().
+  SpriteCache sprites;
+
+  // Both contexts must be polled from the same core until CreateTasks() has
+  // returned.
+  Controller(async_context_t& context, async_context_t& motion_context)
+      : context(context),
+        motion_context(motion_context),
+        oled(context, spi0,
+             {.clock = 2, .data = 3, .reset = 4, .dc = 5, .cs = 6}),
+        buffer(oled.Buffer()),
+        encoders{
+            RotaryEncoder::CreatePio<22, 26>(motion_context),
+            RotaryEncoder::CreatePio<19, 20>(motion_context),
+            RotaryEncoder::CreatePio<17, 16>(motion_context),
+        },
+        buttons{
+            Button::Create<27>(context),
+            Button::Create<21>(context),
+            Button::Create<18>(context),
+        },
+        left_button(
+            Gpio(13, {.direction = Gpio::kInput, .polarity = Gpio::kNegative})),
+        right_button(
+            Gpio(14, {.direction = Gpio::kInput, .polarity = Gpio::kNegative})),
+        speed_control(133'000'000, 1, 0),
+        ramp({.start_velocity = 1'000,
+              .max_acceleration = 400'000,
+              .max_jerk = 4'000'000}),
+        executor(context),
+        motion_executor(motion_context),
+        changed(motion_context),
+        setpoint(context) {
+    const std::uint64_t initial_ipm = 1;
+    level = Q32ToLevel(ToQ32(ppi * initial_ipm) / 60);
+    setpoint.Post({.level = level, .direction = direction});
+
+    Startup();
+    CreateTasks();
+  }
+
+  void Startup() {
+    for (int i = 2; i >= 0; --i) {
+      const Font& font = FontForHeight<64>();
+      trace::Log("Starting in {} seconds", i);
+      // Nothing else runs during startup, so print straight away.
+      trace::Print(std::cout);
+      std::cout.flush();
+      buffer.Clear();
+      const char digit = '0' + i;
+      buffer.DrawStringCentered(font, {&digit, 1}, 0);
+      oled.Update();
+      sleep_ms(1000);
+    }
+    buffer.Clear();
+    oled.Update();
+    trace::Log("Startup");
+  }
+
+  std::vector<Task> tasks;
+
+  void CreateTasks() {
+    const auto add = [&](Task task) { tasks.push_back(std::move(task)); };
+    // On `context`.
+    add(BackgroundTask());
+    add(LogTask());
+    add(UpdateTask());
+    // On `motion_context`.
+    add(EncoderTask(encoders[0], 1));
+    add(EncoderTask(encoders[2], coarse_multiplier));
+    add(DirectionTask());
+    add(MotorTask());
+  }
+
+  Task BackgroundTask() {
+    while (true) {
+      trace::Log("heartbeat");
+      co_await executor.SleepUntil(make_timeout_time_ms(3'000));
+    }
+  }
+
+  // Prints the trace log in batches, so that logging elsewhere never waits
+  // for USB. Sending 'h' over the serial console dumps the latency
+  // histograms.
+  Task LogTask() {
+    while (true) {
+      bool printed = trace::Print(std::cout) > 0;
+      if (getchar_timeout_us(0) == 'h') {
+        probe::Print(std::cout);
+        printed = true;
+      }
+      if (printed) {
+        std::cout.flush();
+      }
+      co_await executor.SleepUntil(make_timeout_time_ms(50));
+    }
+  }
+
+  std::int64_t level = 0;
+  int direction = 0;
+  static constexpr std::int64_t ppr = 8000;
+  static constexpr std::int64_t tpi = 20;
+  static constexpr std::int64_t ppi = ppr * tpi;
+  static constexpr std::int64_t fine_steps_per_octave = kStepsPerOctave;
+  static constexpr std::int64_t coarse_multiplier = 8;
+
+  // Piecewise-linear mapping from knob speed to a gain on each detent's step,
+  // so that fast spins cover octaves quickly while slow turns keep their
+  // resolution. Speeds outside the curve take the gain of the nearest end.
+  struct SpeedCurve {
+    struct Point {
+      // Detents per second.
+      double rate;
+      double gain;
+    };
+    // Ordered by rate.
+    std::vector<Point> points;
+
+    double Gain(double rate) const {
+      if (rate <= points.front().rate) {
+        return points.front().gain;
+      }
+      for (std::size_t i = 1; i < points.size(); ++i) {
+        const Point& a = points[i - 1];
+        const Point& b = points[i];
+        if (rate < b.rate) {
+          const double t = (rate - a.rate) / (b.rate - a.rate);
+          return a.gain + t * (b.gain - a.gain);
+        }
+      }
+      return points.back().gain;
+    }
+  };
+
+  SpeedCurve speed_curve = {.points = {{.rate = 4, .gain = 1},
+                                       {.rate = 15, .gain = 3},
+                                       {.rate = 40, .gain = 8}}};
+
+  Task EncoderTask(RotaryEncoder& encoder, std::int64_t multiplier) {
+    std::int64_t previous = 0;
+    // Fraction of a level not yet applied, carried into the next detent so
+    // that fractional gains average out rather than rounding away. Stays
+    // within +/-0.5, so each detent still moves at least one level.
+    double remainder = 0;
+    while (true) {
+      const std::int64_t current = co_await encoder;
+      const std::int64_t delta = current - previous;
+      previous = current;
+      const double gain = speed_curve.Gain(std::abs(encoder.Rate()));
+      const double change = delta * multiplier * gain + remainder;
+      const std::int64_t steps = std::llround(change);
+      remainder = change - steps;
+      level += steps;
+      Notify();
+    }
+  }
+
+  Task DirectionTask() {
+    while (true) {
+      int new_direction = 0;
+      if (left_button) {
+        new_direction = -1;
+      } else if (right_button) {
+        new_direction = 1;
+      }
+      if (new_direction != direction) {
+        direction = new_direction;
+        Notify();
+      }
+      co_await motion_executor.SleepUntil(make_timeout_time_ms(50));
+    }
+  }
+
+  void Notify() {
+    changed.Notify();
+    setpoint.Post({.level = level, .direction = direction});
+  }
+
+  // Steps the motor speed towards the requested speed along the ramp profile.
+  Task MotorTask() {
+    auto changes = changed.Subscribe();
+    const std::uint32_t tick_us = 1'000;
+    while (true) {
+      ramp.SetTarget(direction * frequency());
+      if (ramp.Done()) {
+        co_await changes;
+        continue;
+      }
+      absolute_time_t next_tick = get_absolute_time();
+      while (!ramp.Done()) {
+        const double velocity = ramp.Step(tick_us / 1e6);
+        if (ramp.Done()) {
+          // The target itself, with the period from the exact rate.
+          speed_control.Set(direction, LevelToQ32(level));
+        } else {
+          speed_control.Set(velocity);
+        }
+        next_tick = delayed_by_us(next_tick, tick_us);
+        co_await motion_executor.SleepUntil(next_tick);
+        ramp.SetTarget(direction * frequency());
+      }
+    }
+  }
+
+  // Everything UpdateTask() and Startup() draw must be in the font subsets
+  // listed in font/CMakeLists.txt.
+  static_assert(FontForHeight<8>().Contains("FineCoarse"));
+  static_assert(FontForHeight<8>().Contains("inmmmin"));
+  static_assert(FontForHeight<24>().Contains("0123456789."));
+  static_assert(FontForHeight<32>().Contains("<>"));
+  static_assert(FontForHeight<64>().Contains("0123456789"));
+
+  // Upper bound on display updates. Setpoints posted faster than this are
+  // coalesced, and only the latest is drawn.
+  static constexpr std::uint32_t max_frames_per_second = 30;
+
+  // Redraws only the parts of the display whose contents changed, so that the
+  // display driver only needs to send those regions. The first change after
+  // an idle period is drawn straight away; later ones wait for the next frame
+  // slot.
+  Task UpdateTask() {
+    constexpr const Font& value_font = FontForHeight<24>();
+    constexpr const Font& unit_font = FontForHeight<8>();
+    constexpr const Font& arrow_font = FontForHeight<32>();
+    // The arrows straddle the two lines, and are blitted in whole pages.
+    constexpr std::size_t arrow_y = value_font.height - arrow_font.height / 2;
+    static_assert(arrow_y % 8 == 0);
+    // The speed text is 6.5 characters wide, 5 from the value and 1.5 from the
+    // units, and centered. Its width never changes, so neither do the units.
+    const std::size_t value_x =
+        buffer.CenterX(Readout::kWidth * value_font.width +
+                       3 * value_font.width / 2);
+    const std::size_t units_x = value_x + Readout::kWidth * value_font.width;
+    // Fixed images are rendered once into sprites. All of them sit at
+    // page-aligned rows, so they can be copied in whole blocks.
+    auto text_sprite = [&](const Font& font, std::string_view text) {
+      OledBuffer sprite = sprites.Create(
+          OledBuffer::TextWidth(font, text), (font.height + 7) / 8 * 8);
+      sprite.DrawString(font, text, 0, 0);
+      return sprite;
+    };
+    // unit-per-minute fraction drawn so that it takes up 1 digit height
+    // vertically, 2 digit widths horizontally, and lining up with the top and
+    // bottom edges of the digit text.
+    auto units_sprite = [&](std::string_view unit) {
+      OledBuffer sprite = sprites.Create(21, value_font.height);
+      sprite.DrawString(unit_font, unit, 7, 3);
+      sprite.DrawLineH(11, 4, 20);
+      sprite.DrawString(unit_font, "min", 5, 12);
+      return sprite;
+    };
+    const OledBuffer left_arrow = text_sprite(arrow_font, "<");
+    const OledBuffer right_arrow = text_sprite(arrow_font, ">");
+    // `drawn` holds the value text currently on the display for this line.
+    // Only the digits that changed are replaced.
+    auto draw_speed = [&](Q32 value, int y, Readout& drawn) {
+      const Readout readout = FormatReadout(value);
+      std::size_t x = value_x;
+      for (std::size_t i = 0; i < Readout::kWidth; ++i) {
+        if (readout.chars[i] != drawn.chars[i]) {
+          buffer.ClearRect(x, y, x + value_font.width, y + value_font.height);
+          buffer.DrawChar(value_font, readout.chars[i], x, y);
+        }
+        x += value_font.width;
+      }
+      drawn = readout;
+    };
+    int drawn_direction = 0;
+    auto draw_arrow = [&](int direction) {
+      if (direction == drawn_direction) {
+        return;
+      }
+      drawn_direction = direction;
+      const std::size_t y = arrow_y;
+      const std::size_t right_x = buffer.Width() - arrow_font.width;
+      if (direction == -1) {
+        buffer.Blit(left_arrow, 0, y / 8);
+      } else {
+        buffer.ClearRect(0, y, arrow_font.width, y + arrow_font.height);
+      }
+      if (direction == 1) {
+        buffer.Blit(right_arrow, right_x, y / 8);
+      } else {
+        buffer.ClearRect(right_x, y, buffer.Width(), y + arrow_font.height);
+      }
+    };
+    // The labels and units never change.
+    const Font& label_font = FontForHeight<8>();
+    const OledBuffer fine = text_sprite(label_font, "Fine");
+    const OledBuffer coarse = text_sprite(label_font, "Coarse");
+    const std::size_t label_page = buffer.Pages() - 1;
+    buffer.Blit(fine, 0, label_page);
+    buffer.Blit(coarse, buffer.Width() - coarse.Width(), label_page);
+    buffer.Blit(units_sprite("in"), units_x, 0);
+    buffer.Blit(units_sprite("mm"), units_x, value_font.height / 8);
+    // No characters, so that the first frame draws every digit.
+    Readout drawn_ipm = {};
+    Readout drawn_mmpm = {};
+    const std::uint32_t frame_interval_us = 1'000'000 / max_frames_per_second;
+    absolute_time_t next_frame = get_absolute_time();
+    std::optional<Setpoint> drawn;
+    while (true) {
+      // The constructor posted the initial setpoint, so the first wait
+      // returns immediately.
+      co_await setpoint;
+      co_await executor.SleepUntil(next_frame);
+      // Posts while sleeping leave the mailbox notified, so a later pass may
+      // find nothing new to draw.
+      const Setpoint shown = setpoint.Peek();
+      if (shown == drawn) {
+        continue;
+      }
+      drawn = shown;
+      next_frame = make_timeout_time_us(frame_interval_us);
+      probe::Stamp(probe::Point::kRenderStart);
+      const Q32 shown_frequency = LevelToQ32(shown.level);
+      const Q32 shown_ipm = ipm(shown_frequency);
+      trace::Log("Level: {} frequency: {} IPM: {} direction: {}", shown.level,
+                 ToDouble(shown_frequency), ToDouble(shown_ipm),
+                 shown.direction);
+      // Update display.
+      draw_speed(shown_ipm, 0, drawn_ipm);
+      draw_speed(shown_ipm * 254 / 10, 24, drawn_mmpm);
+      draw_arrow(shown.direction);
+      probe::Since(probe::Point::kRenderStart, probe::Histogram::kRender);
+      probe::Stamp(probe::Point::kTransferStart);
+      co_await oled.UpdateAsync();
+      probe::Since(probe::Point::kTransferStart, probe::Histogram::kTransfer);
+    }
+  }
+
+  // Step rate in Hz. The ramp works in floating point, but the rate itself
+  // comes from a table rather than exp2(), as it's needed on every tick.
+  static double frequency(std::int64_t level) {
+    return ToDouble(LevelToQ32(level));
+  }
+  double frequency() const { return frequency(level); }
+
+  // Inches per minute for a step rate, both in Q32.32. Exact to within the
+  // last fractional bit for any rate below 2^26 Hz.
+  static Q32 ipm(Q32 frequency) { return frequency * 60 / ppi; }
+};
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <span>
+
+// Table-driven CRC-16/MODBUS, as in rs232/crc.py. The table is generated at
+// compile time from the reflected polynomial rather than spelled out.
+namespace crc16_internal {
+constexpr std::array<std::uint16_t, 256> Table() {
+  std::array<std::uint16_t, 256> table = {};
+  for (unsigned i = 0; i < table.size(); ++i) {
+    std::uint16_t crc = i;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+    table[i] = crc;
+  }
+  return table;
+}
+
+inline constexpr auto kTable = Table();
+}  // namespace crc16_internal
+
+constexpr std::uint16_t Crc16(std::span<const std::uint8_t> data) {
+  std::uint16_t crc = 0xFFFF;
+  for (std::uint8_t byte : data) {
+    crc = (crc >> 8) ^ crc16_internal::kTable[(crc ^ byte) & 0xFF];
+  }
+  return crc;
+}
+
+static_assert(Crc16(std::array<std::uint8_t, 9>{'1', '2', '3', '4', '5', '6',
+                                                '7', '8', '9'}) == 0x4B37);
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+// Conversions between speed levels and fixed-point rates. Each level is
+// 2^(1/kStepsPerOctave) times faster than the one below it, so a rate is a
+// mantissa from a 160-entry table shifted by whole octaves. The RP2040 has no
+// FPU, and this replaces a soft-float exp2() with a table load and a shift.
+//
+// Rates are unsigned fixed point with 32 fractional bits (Q32.32). The table
+// is accurate to 2^-31 relative, well beyond the resolution of the step
+// generator.
+inline constexpr std::int64_t kStepsPerOctave = 160;
+
+using Q32 = std::uint64_t;
+inline constexpr int kQ32FractionBits = 32;
+
+constexpr Q32 ToQ32(std::uint64_t value) { return value << kQ32FractionBits; }
+
+constexpr double ToDouble(Q32 value) { return value * 0x1p-32; }
+
+namespace fixed_exp2_internal {
+
+// 2^x for x in [0, 1), by its Taylor series. Only used to build the table.
+constexpr double Exp2Fraction(double x) {
+  const double y = x * 0.693147180559945309417;
+  double sum = 1;
+  double term = 1;
+  for (int n = 1; n < 30; ++n) {
+    term *= y / n;
+    sum += term;
+  }
+  return sum;
+}
+
+// kMantissas[i] is 2^(i / kStepsPerOctave) with 31 fractional bits, so every
+// entry has its top bit set.
+constexpr std::array<std::uint32_t, kStepsPerOctave> Mantissas() {
+  std::array<std::uint32_t, kStepsPerOctave> table = {};
+  for (std::size_t i = 0; i < table.size(); ++i) {
+    const double value =
+        Exp2Fraction(static_cast<double>(i) / kStepsPerOctave) * 0x1p31;
+    table[i] = static_cast<std::uint32_t>(value + 0.5);
+  }
+  return table;
+}
+
+inline constexpr auto kMantissas = Mantissas();
+inline constexpr int kMantissaFractionBits = 31;
+
+static_assert(kMantissas.front() == 0x8000'0000);
+static_assert(kMantissas.back() > 0xFE00'0000);
+
+}  // namespace fixed_exp2_internal
+
+// 2^(level / kStepsPerOctave), rounded to the nearest Q32.32 value. Saturates
+// above 2^31.
+constexpr Q32 LevelToQ32(std::int64_t level) {
+  using namespace fixed_exp2_internal;
+  // Anything outside +/-64 octaves saturates or rounds to zero anyway, and
+  // 32-bit division uses the RP2040's hardware divider.
+  const std::int32_t clamped = std::clamp<std::int64_t>(
+      level, -64 * kStepsPerOctave, 64 * kStepsPerOctave);
+  // Floor division, so that the index is never negative.
+  std::int32_t octave = clamped / kStepsPerOctave;
+  std::int32_t index = clamped % kStepsPerOctave;
+  if (index < 0) {
+    index += kStepsPerOctave;
+    --octave;
+  }
+  const Q32 mantissa = kMantissas[index];
+  const std::int32_t shift = octave + kQ32FractionBits - kMantissaFractionBits;
+  if (shift >= 0) {
+    // The mantissa has 32 significant bits.
+    if (shift > 31) {
+      return std::numeric_limits<Q32>::max();
+    }
+    return mantissa << shift;
+  }
+  if (shift < -32) {
+    return 0;
+  }
+  return (mantissa + (Q32{1} << (-shift - 1))) >> -shift;
+}
+
+// The level whose rate is closest to `value`, which must not be zero. The
+// inverse of LevelToQ32() for all levels it doesn't saturate or round to zero.
+constexpr std::int64_t Q32ToLevel(Q32 value) {
+  using namespace fixed_exp2_internal;
+  // Normalize to a mantissa with the same fixed point as the table.
+  const int width = std::bit_width(value);
+  const std::int64_t octave = width - 1 - kQ32FractionBits;
+  const Q32 mantissa =
+      width > 32 ? value >> (width - 32) : value << (32 - width);
+  // The last entry at or below the mantissa, which the first entry always is.
+  const auto above =
+      std::upper_bound(kMantissas.begin(), kMantissas.end(), mantissa);
+  const std::int64_t index = above - kMantissas.begin() - 1;
+  // The entry after the last is the first of the next octave.
+  const Q32 next = above == kMantissas.end() ? Q32{1} << 32 : *above;
+  const std::int64_t level = octave * kStepsPerOctave + index;
+  return next - mantissa <= mantissa - kMantissas[index] ? level + 1 : level;
+}
+
+static_assert(LevelToQ32(0) == ToQ32(1));
+static_assert(LevelToQ32(kStepsPerOctave * 10) == ToQ32(1024));
+static_assert(LevelToQ32(-kStepsPerOctave) == ToQ32(1) / 2);
+static_assert(Q32ToLevel(ToQ32(1)) == 0);
+static_assert(Q32ToLevel(LevelToQ32(-1)) == -1);
+static_assert(Q32ToLevel(LevelToQ32(1999)) == 1999);
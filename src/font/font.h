@@ -2,23 +2,111 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <span>
+#include <string_view>
 
+// Reads a glyph's blocks in order, decoding them if the font is run-length
+// encoded. Each packet starts with a header byte: with the top bit set, the
+// next byte repeats (header & 0x7F) + 1 times; otherwise header + 1 literal
+// bytes follow.
+class GlyphReader {
+ public:
+  constexpr GlyphReader(const std::uint8_t* data, bool encoded)
+      : data_(data), encoded_(encoded) {}
+
+  constexpr std::uint8_t Next() {
+    if (!encoded_) {
+      return *data_++;
+    }
+    if (remaining_ == 0) {
+      const std::uint8_t header = *data_++;
+      repeat_ = header & 0x80;
+      remaining_ = (header & 0x7F) + 1;
+    }
+    --remaining_;
+    if (repeat_ && remaining_ > 0) {
+      return *data_;
+    }
+    return *data_++;
+  }
+
+ private:
+  const std::uint8_t* data_;
+  const bool encoded_;
+  // Blocks left in the current packet.
+  unsigned remaining_ = 0;
+  bool repeat_ = false;
+};
+
+// A monospaced bitmap font, holding a subset of printable ASCII.
 struct Font {
+  static constexpr std::uint8_t kMissing = 0xFF;
+
   std::ptrdiff_t width;
   std::ptrdiff_t height;
+  // Size of a glyph once decoded.
   std::ptrdiff_t bytes_per_char;
+  // Glyph number of each character from ' ' to '~', or kMissing for the
+  // characters left out of the font.
+  std::span<const std::uint8_t> index;
+  // Each glyph's blocks, bytes_per_char apiece unless run-length encoded.
   std::span<const std::uint8_t> data;
+  // Where each encoded glyph starts in `data`, followed by the end. Empty if
+  // the glyphs aren't encoded.
+  std::span<const std::uint16_t> offsets;
 
-  // Pointer to start of data for the given character, which must be in the
-  // range [' ', '~'].
-  const std::uint8_t* operator[](char c) const;
+  constexpr bool Contains(char c) const {
+    return c >= ' ' && c <= '~' && index[c - ' '] != kMissing;
+  }
+  // True if every character of `text` is in the font. Fonts are generated
+  // with only the characters listed in CMakeLists.txt, so callers drawing
+  // fixed text should static_assert this.
+  constexpr bool Contains(std::string_view text) const {
+    for (char c : text) {
+      if (!Contains(c)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Reader for the given character's blocks, which must be in the font.
+  constexpr GlyphReader Glyph(char c) const {
+    const std::size_t glyph = index[c - ' '];
+    if (offsets.empty()) {
+      return {&data[glyph * bytes_per_char], false};
+    }
+    return {&data[offsets[glyph]], true};
+  }
 };
 
-inline const std::uint8_t* Font::operator[](char c) const {
-  return &data[(c - ' ') * bytes_per_char];
-}
+// Generated by generate_fonts.py from the BDF files listed in CMakeLists.txt.
+// The glyph data is defined in a generated source file, so that it is compiled
+// once and placed in flash.
+#include "font_data.h"
 
-std::span<const Font> AllFonts();
+constexpr std::span<const Font> AllFonts() { return font_data::kFonts; }
 
-const Font& FontForHeight(std::size_t height);
+namespace font_internal {
+// Index of the font with the given height, or the number of fonts if there
+// is none.
+constexpr std::size_t IndexForHeight(std::ptrdiff_t height) {
+  std::size_t i = 0;
+  while (i < std::size(font_data::kFonts) &&
+         font_data::kFonts[i].height != height) {
+    ++i;
+  }
+  return i;
+}
+}  // namespace font_internal
+
+// The font with the given height, resolved at compile time. Fails to compile
+// if there is none.
+template <std::ptrdiff_t kHeight>
+constexpr const Font& FontForHeight() {
+  constexpr std::size_t index = font_internal::IndexForHeight(kHeight);
+  static_assert(index < std::size(font_data::kFonts),
+                "No font with this height; see sizes in font/CMakeLists.txt");
+  return font_data::kFonts[index];
+}
@@ -2,13 +2,13 @@ from math import ceil
 import numpy as np
 from bdfparser import Font
 
+# Printable ASCII, from " " to "~".
+NUM_CHARS = 95
 
-def serialize_font(bdf_path):
-    with bdf_path.open("rt") as f:
-        font = Font(f)
+
+def serialize_font(font):
     width = font.headers["fbbx"]
     height = font.headers["fbby"]
-    yield bytes([width, height])
     # Each image is split up into blocks where each block is a byte of 8
     # contiguous pixels vertically, where the LSB is the top-most pixel.
 
@@ -30,29 +30,175 @@ def serialize_font(bdf_path):
         yield packed.tobytes()
 
 
+# Marks characters left out of a font's glyph index.
+MISSING = 0xFF
+
+
+def rle_encode(data):
+    """Run-length encodes one glyph's blocks, as decoded by GlyphReader.
+
+    Each packet starts with a header byte. With the top bit set, the next byte
+    repeats (header & 0x7F) + 1 times; otherwise header + 1 literal bytes
+    follow.
+    """
+    output = bytearray()
+    literals = bytearray()
+
+    def flush_literals():
+        while literals:
+            chunk = literals[:128]
+            output.append(len(chunk) - 1)
+            output.extend(chunk)
+            del literals[:128]
+
+    i = 0
+    while i < len(data):
+        run = 1
+        while i + run < len(data) and data[i + run] == data[i] and run < 128:
+            run += 1
+        # A run of two costs as much as two literals, and would split them.
+        if run >= 3:
+            flush_literals()
+            output.extend([0x80 | (run - 1), data[i]])
+            i += run
+        else:
+            literals.append(data[i])
+            i += 1
+    flush_literals()
+    return bytes(output)
+
+
+class FontData:
+    def __init__(self, font, glyphs, rle):
+        self.width = font.headers["fbbx"]
+        self.height = font.headers["fbby"]
+        all_glyphs = list(serialize_font(font))
+        self.bytes_per_char = len(all_glyphs[0])
+        codes = range(ord(" "), ord("~") + 1)
+        included = sorted(set(glyphs)) if glyphs else [chr(c) for c in codes]
+        self.index = bytes(
+            included.index(chr(c)) if chr(c) in included else MISSING
+            for c in codes
+        )
+        subset = [all_glyphs[ord(c) - ord(" ")] for c in included]
+        self.offsets = None
+        if rle:
+            encoded = [rle_encode(glyph) for glyph in subset]
+            self.offsets = [0]
+            for glyph in encoded:
+                self.offsets.append(self.offsets[-1] + len(glyph))
+            if self.offsets[-1] > 0xFFFF:
+                raise ValueError(
+                    f"{self.width}x{self.height} glyphs take "
+                    f"{self.offsets[-1]} bytes encoded, beyond the 16-bit "
+                    "offsets; include fewer glyphs or turn off RLE"
+                )
+            subset = encoded
+        self.data = b"".join(subset)
+
+    def name(self, suffix):
+        return f"kFont{self.width}x{self.height}{suffix}"
+
+    def declarations(self):
+        # Inline, so that which characters a font includes is known at compile
+        # time.
+        yield from define_array(
+            "std::uint8_t", self.name("Index"), self.index, "inline constexpr"
+        )
+        yield f"extern const std::uint8_t {self.name('Data')}[{len(self.data)}];"
+        if self.offsets:
+            yield (
+                f"extern const std::uint16_t {self.name('Offsets')}"
+                f"[{len(self.offsets)}];"
+            )
+
+    def initializer(self):
+        offsets = self.name("Offsets") if self.offsets else "{}"
+        return (
+            f"{{{self.width}, {self.height}, {self.bytes_per_char}, "
+            f"{self.name('Index')}, {self.name('Data')}, {offsets}}}"
+        )
+
+    def definitions(self):
+        yield from define_array("std::uint8_t", self.name("Data"), self.data)
+        if self.offsets:
+            yield from define_array(
+                "std::uint16_t", self.name("Offsets"), self.offsets
+            )
+
+
+def define_array(element_type, name, values, qualifiers="const"):
+    yield f"\n{qualifiers} {element_type} {name}[{len(values)}] = {{"
+    for start in range(0, len(values), 12):
+        yield "    " + ", ".join(f"{v:#04x}" for v in values[start : start + 12]) + ","
+    yield "};"
+
+
+def write_header(fonts, output):
+    """Declares the glyph data and defines the constexpr font table."""
+    output.write("// Generated by generate_fonts.py. Do not edit.\n")
+    output.write("// Included by font.h, after the definition of Font.\n")
+    output.write("#pragma once\n\n#include <cstdint>\n\n")
+    output.write("namespace font_data {\n")
+    for font in fonts:
+        for line in font.declarations():
+            output.write(line + "\n")
+    output.write("\n// Ordered by height.\ninline constexpr Font kFonts[] = {\n")
+    for font in fonts:
+        output.write(f"    {font.initializer()},\n")
+    output.write("};\n\n}  // namespace font_data\n")
+
+
+def write_source(fonts, output):
+    """Defines the glyph data, which the linker keeps in flash."""
+    output.write("// Generated by generate_fonts.py. Do not edit.\n")
+    output.write('#include "font.h"\n\nnamespace font_data {\n')
+    for font in fonts:
+        for line in font.definitions():
+            output.write(line + "\n")
+    output.write("\n}  // namespace font_data\n")
+
+
 def main():
     from argparse import ArgumentParser
     from pathlib import Path
 
     parser = ArgumentParser()
     parser.add_argument(
-        "bdf_paths",
-        type=Path,
+        "--font",
         nargs="+",
-        help="Path to Glyph Bitmap Distribution Format files.",
+        action="append",
+        required=True,
+        metavar="BDF_PATH [GLYPHS]",
+        help="Glyph Bitmap Distribution Format file, and optionally the "
+        "characters to include from it. The default is all printable ASCII.",
+    )
+    parser.add_argument(
+        "--rle", action="store_true", help="Run-length encode the glyphs."
     )
     parser.add_argument(
-        "--output", "-o", type=Path, help="Path to write block blob to."
+        "--header", type=Path, required=True, help="C++ header to write."
+    )
+    parser.add_argument(
+        "--source", type=Path, required=True, help="C++ source to write."
     )
 
     args = parser.parse_args()
-    num_fonts = len(args.bdf_paths)
 
-    with args.output.open("wb") as output:
-        output.write(bytes([num_fonts]))
-        for bdf_path in args.bdf_paths:
-            for blob in serialize_font(bdf_path):
-                output.write(blob)
+    fonts = []
+    for font_args in args.font:
+        if len(font_args) > 2:
+            parser.error(f"Too many arguments to --font: {font_args}")
+        bdf_path = font_args[0]
+        glyphs = font_args[1] if len(font_args) > 1 else ""
+        with open(bdf_path, "rt") as f:
+            fonts.append(FontData(Font(f), glyphs, args.rle))
+    fonts.sort(key=lambda font: font.height)
+
+    with args.header.open("wt") as output:
+        write_header(fonts, output)
+    with args.source.open("wt") as output:
+        write_source(fonts, output)
 
 
 if __name__ == "__main__":
@@ -0,0 +1,133 @@
+// Checks OledBuffer::DrawChar() against a per-pixel reference for every glyph
+// of every font, at each vertical offset within a page and clipped at the
+// right and bottom edges, and compares their cost. Times are host wall-clock
+// time per character.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "font/font.h"
+#include "oled_buffer.h"
+
+namespace {
+
+constexpr std::size_t kWidth = 128;
+constexpr std::size_t kHeight = 64;
+
+// Draws `letter` one pixel at a time from its decoded blocks.
+void ReferenceDrawChar(OledBuffer& buffer, const Font& font, char letter,
+                       std::size_t x0, std::size_t y0) {
+  if (!font.Contains(letter)) {
+    return;
+  }
+  GlyphReader glyph = font.Glyph(letter);
+  std::vector<std::uint8_t> blocks(font.bytes_per_char);
+  for (std::uint8_t& block : blocks) {
+    block = glyph.Next();
+  }
+  for (std::ptrdiff_t y = 0; y < font.height; ++y) {
+    for (std::ptrdiff_t x = 0; x < font.width; ++x) {
+      const std::uint8_t block = blocks[(y / 8) * font.width + x];
+      if ((block >> (y % 8) & 1) && x0 + x < kWidth && y0 + y < kHeight) {
+        buffer(x0 + x, y0 + y) = true;
+      }
+    }
+  }
+}
+
+struct Position {
+  std::size_t x0;
+  std::size_t y0;
+};
+
+// Each offset within a page, and positions that clip at the right, the
+// bottom and both.
+std::vector<Position> Positions(const Font& font) {
+  std::vector<Position> positions;
+  for (std::size_t shift = 0; shift < 8; ++shift) {
+    positions.push_back({.x0 = 3, .y0 = 8 + shift});
+    const std::size_t right = kWidth - font.width / 2;
+    const std::size_t bottom = kHeight - font.height / 2 + shift;
+    positions.push_back({.x0 = right, .y0 = shift});
+    positions.push_back({.x0 = 3, .y0 = bottom});
+    positions.push_back({.x0 = right, .y0 = bottom});
+  }
+  return positions;
+}
+
+}  // namespace
+
+int main() {
+  std::vector<std::uint8_t> background(kWidth * kHeight / 8);
+  std::mt19937 random(1);
+  for (std::uint8_t& block : background) {
+    block = random();
+  }
+  std::vector<std::uint8_t> actual_data(background.size());
+  std::vector<std::uint8_t> expected_data(background.size());
+  OledBuffer actual(actual_data.data(), kWidth, kHeight);
+  OledBuffer expected(expected_data.data(), kWidth, kHeight);
+
+  int checked = 0;
+  int mismatches = 0;
+  for (const Font& font : AllFonts()) {
+    for (char letter = ' '; letter <= '~'; ++letter) {
+      if (!font.Contains(letter)) {
+        continue;
+      }
+      for (const Position& position : Positions(font)) {
+        // Over a random background, as glyphs are drawn by ORing them in.
+        actual_data = background;
+        expected_data = background;
+        actual.DrawChar(font, letter, position.x0, position.y0);
+        ReferenceDrawChar(expected, font, letter, position.x0, position.y0);
+        ++checked;
+        if (actual_data != expected_data) {
+          std::cerr << font.width << "x" << font.height << " '" << letter
+                    << "' at (" << position.x0 << ", " << position.y0
+                    << ") differs from the reference" << std::endl;
+          ++mismatches;
+        }
+      }
+    }
+  }
+  std::cout << "Checked " << checked << " glyph placements, " << mismatches
+            << " mismatches" << std::endl;
+
+  using Clock = std::chrono::steady_clock;
+  const auto ns_per_char = [&](auto draw) {
+    constexpr int kRepeats = 200;
+    int chars = 0;
+    const auto start = Clock::now();
+    for (int repeat = 0; repeat < kRepeats; ++repeat) {
+      for (const Font& font : AllFonts()) {
+        for (char letter = ' '; letter <= '~'; ++letter) {
+          if (font.Contains(letter)) {
+            draw(font, letter, repeat % 8);
+            ++chars;
+          }
+        }
+      }
+    }
+    return std::chrono::duration<double, std::nano>(Clock::now() - start)
+               .count() /
+           chars;
+  };
+  std::cout << "Host ns per character:" << std::endl;
+  std::cout << std::fixed << std::setprecision(0) << "  DrawChar():  "
+            << ns_per_char([&](const Font& font, char letter, std::size_t y0) {
+                 actual.DrawChar(font, letter, 0, y0);
+               })
+            << std::endl;
+  std::cout << "  per pixel:   "
+            << ns_per_char([&](const Font& font, char letter, std::size_t y0) {
+                 ReferenceDrawChar(expected, font, letter, 0, y0);
+               })
+            << std::endl;
+  return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,121 @@
+#include "host/fake_drive.h"
+
+#include "crc16.h"
+#include "host/sim.h"
+
+namespace {
+std::uint16_t Read16(std::span<const std::uint8_t> data, std::size_t offset) {
+  return (data[offset] << 8) | data[offset + 1];
+}
+
+void Append16(std::vector<std::uint8_t>& data, std::uint16_t value) {
+  data.push_back(value >> 8);
+  data.push_back(value & 0xFF);
+}
+}  // namespace
+
+FakeDrive::FakeDrive(uart_inst_t* uart, std::uint8_t address)
+    : uart_(uart), address_(address) {
+  sim::OnUartWrite([this](uart_inst_t* uart,
+                          std::span<const std::uint8_t> data) {
+    if (uart != uart_) {
+      return;
+    }
+    for (std::uint8_t byte : data) {
+      Receive(byte);
+    }
+  });
+}
+
+void FakeDrive::Receive(std::uint8_t byte) {
+  request_.push_back(byte);
+  const std::optional<std::size_t> size = RequestSize();
+  if (!size) {
+    return;
+  }
+  // Unsupported functions leave nothing to wait for, so resynchronize.
+  if (*size == 0) {
+    request_.clear();
+    return;
+  }
+  if (request_.size() < *size) {
+    return;
+  }
+  HandleRequest(request_);
+  request_.clear();
+}
+
+std::optional<std::size_t> FakeDrive::RequestSize() const {
+  if (request_.size() < 2) {
+    return std::nullopt;
+  }
+  switch (request_[1]) {
+    case 3:
+    case 6:
+      return 8;
+    case 16:
+      // Header, byte count, payload and checksum.
+      if (request_.size() < 7) {
+        return std::nullopt;
+      }
+      return 9 + request_[6];
+    default:
+      return 0;
+  }
+}
+
+void FakeDrive::HandleRequest(std::span<const std::uint8_t> request) {
+  const auto payload = request.first(request.size() - 2);
+  const std::uint16_t crc = Crc16(payload);
+  if (request[0] != address_ || request[request.size() - 2] != (crc & 0xFF) ||
+      request[request.size() - 1] != (crc >> 8)) {
+    return;
+  }
+  ++requests_;
+  const std::uint8_t function = request[1];
+  const std::uint16_t key = Read16(request, 2);
+  if (faults_.exception_code != 0) {
+    const std::uint8_t response[] = {address_, std::uint8_t(function | 0x80),
+                                     faults_.exception_code};
+    Respond(response);
+  } else if (function == 3) {
+    const std::uint16_t count = Read16(request, 4);
+    std::vector<std::uint8_t> response = {address_, function,
+                                          std::uint8_t(2 * count)};
+    for (std::uint16_t i = 0; i < count; ++i) {
+      Append16(response, Get(key + i));
+    }
+    Respond(response);
+  } else if (function == 6) {
+    registers_[key] = Read16(request, 4);
+    Respond(payload);
+  } else if (function == 16) {
+    const std::uint16_t count = Read16(request, 4);
+    for (std::uint16_t i = 0; i < count; ++i) {
+      registers_[key + i] = Read16(request, 7 + 2 * i);
+    }
+    Respond(payload.first(6));
+  }
+}
+
+void FakeDrive::Respond(std::span<const std::uint8_t> payload) {
+  std::vector<std::uint8_t> response(payload.begin(), payload.end());
+  if (faults_.wrong_address) {
+    response[0] = address_ + 1;
+  }
+  std::uint16_t crc = Crc16(response);
+  if (faults_.corrupt_checksum) {
+    crc ^= 1;
+  }
+  response.push_back(crc & 0xFF);
+  response.push_back(crc >> 8);
+  sim::Schedule(sim::Now() + kTurnaroundUs,
+                [uart = uart_, response = std::move(response)] {
+                  sim::UartReceive(uart, response);
+                });
+}
+
+std::uint16_t FakeDrive::Get(std::uint16_t key) const {
+  const auto it = registers_.find(key);
+  return it == registers_.end() ? 1000 + key : it->second;
+}
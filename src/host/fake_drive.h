@@ -0,0 +1,56 @@
+#pragma once
+
+#include <hardware/uart.h>
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <span>
+#include <vector>
+
+// Simulated motor drive answering Modbus RTU requests on a UART; the host
+// equivalent of rs232/fake_stream.py. Registers that were never written read
+// as 1000 + address. Replaces any other sim::OnUartWrite() observer.
+class FakeDrive {
+ public:
+  FakeDrive(uart_inst_t* uart, std::uint8_t address = 63);
+
+  // Delay between the end of a request and the start of its response.
+  static constexpr std::uint64_t kTurnaroundUs = 1'000;
+
+  // Number of requests answered so far.
+  std::size_t Requests() const { return requests_; }
+
+  // Faults to put into the responses to later requests.
+  struct Faults {
+    // Respond with this Modbus exception code instead, if nonzero.
+    std::uint8_t exception_code = 0;
+    // Respond as though from another address.
+    bool wrong_address = false;
+    // Send a checksum that doesn't match the response.
+    bool corrupt_checksum = false;
+  };
+
+  void SetFaults(Faults faults) { faults_ = faults; }
+
+ private:
+  // Accumulates request bytes as they arrive off the wire.
+  void Receive(std::uint8_t byte);
+
+  // Size of the request in `request_`, once enough of it has arrived to tell.
+  std::optional<std::size_t> RequestSize() const;
+
+  void HandleRequest(std::span<const std::uint8_t> request);
+
+  // Sends `payload` followed by its checksum after the turnaround time.
+  void Respond(std::span<const std::uint8_t> payload);
+
+  std::uint16_t Get(std::uint16_t key) const;
+
+  uart_inst_t* uart_;
+  std::uint8_t address_;
+  std::vector<std::uint8_t> request_;
+  std::size_t requests_ = 0;
+  std::map<std::uint16_t, std::uint16_t> registers_;
+  Faults faults_;
+};
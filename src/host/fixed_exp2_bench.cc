@@ -0,0 +1,92 @@
+// Checks the table-driven level conversions against the double-precision
+// exp2()/log2() they replace, over every level the controller can reach, and
+// compares their cost. Times are host wall-clock time per call, where exp2()
+// has an FPU to run on; on the RP2040 it is a soft-float routine.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+#include "fixed_exp2.h"
+
+namespace {
+
+// Levels from about 2^-10 Hz to 2^24 Hz.
+constexpr std::int64_t kMinLevel = -10 * kStepsPerOctave;
+constexpr std::int64_t kMaxLevel = 24 * kStepsPerOctave;
+
+double DoubleFrequency(std::int64_t level) {
+  return std::exp2(static_cast<double>(level) / kStepsPerOctave);
+}
+
+// Keeps the compiler from discarding the results.
+volatile double sink;
+
+template <typename F>
+double NsPerCall(F f) {
+  constexpr int kRepeats = 200;
+  using Clock = std::chrono::steady_clock;
+  const auto start = Clock::now();
+  for (int repeat = 0; repeat < kRepeats; ++repeat) {
+    for (std::int64_t level = kMinLevel; level <= kMaxLevel; ++level) {
+      sink = f(level);
+    }
+  }
+  const auto elapsed = Clock::now() - start;
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         (kRepeats * (kMaxLevel - kMinLevel + 1));
+}
+
+}  // namespace
+
+int main() {
+  bool ok = true;
+  double max_error = 0;
+  for (std::int64_t level = kMinLevel; level <= kMaxLevel; ++level) {
+    const double expected = DoubleFrequency(level);
+    const double actual = ToDouble(LevelToQ32(level));
+    // Below 1 Hz, rounding to 32 fractional bits dominates.
+    if (level >= 0) {
+      max_error = std::max(max_error, std::abs(actual / expected - 1));
+    }
+    if (Q32ToLevel(LevelToQ32(level)) != level) {
+      std::cerr << "Level " << level << " doesn't round trip" << std::endl;
+      ok = false;
+    }
+  }
+  constexpr double kMaxError = 1e-9;
+  if (max_error > kMaxError) {
+    std::cerr << "Relative error " << max_error << " exceeds " << kMaxError
+              << std::endl;
+    ok = false;
+  }
+
+  // Rates between levels round to the nearer one, as the controller did
+  // with std::round(log2()).
+  for (std::uint64_t hz = 1; hz < (1 << 24); hz = hz * 3 / 2 + 1) {
+    for (std::uint64_t denominator : {1, 7, 60}) {
+      const Q32 value = ToQ32(hz) / denominator;
+      const std::int64_t expected = std::llround(
+          kStepsPerOctave * std::log2(static_cast<double>(hz) / denominator));
+      if (Q32ToLevel(value) != expected) {
+        std::cerr << hz << "/" << denominator << " Hz: level "
+                  << Q32ToLevel(value) << ", expected " << expected
+                  << std::endl;
+        ok = false;
+      }
+    }
+  }
+
+  std::cout << "Max relative error: " << max_error << std::endl;
+  std::cout << "Host ns per level to frequency:" << std::endl;
+  std::cout << std::fixed << std::setprecision(1)
+            << "  exp2(): " << NsPerCall(DoubleFrequency) << std::endl;
+  std::cout << "  table:  " << NsPerCall([](std::int64_t level) {
+    return LevelToQ32(level);
+  }) << std::endl;
+  return ok ? 0 : 1;
+}
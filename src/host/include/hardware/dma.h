@@ -0,0 +1,56 @@
+#pragma once
+
+#include "pico/types.h"
+
+#define NUM_DMA_CHANNELS 12
+
+enum dma_channel_transfer_size {
+  DMA_SIZE_8 = 0,
+  DMA_SIZE_16 = 1,
+  DMA_SIZE_32 = 2,
+};
+
+typedef struct {
+  enum dma_channel_transfer_size size;
+  uint dreq;
+  bool read_increment;
+  bool write_increment;
+} dma_channel_config;
+
+int dma_claim_unused_channel(bool required);
+void dma_channel_unclaim(uint channel);
+
+dma_channel_config dma_channel_get_default_config(uint channel);
+inline void channel_config_set_transfer_data_size(
+    dma_channel_config* c, enum dma_channel_transfer_size size) {
+  c->size = size;
+}
+inline void channel_config_set_dreq(dma_channel_config* c, uint dreq) {
+  c->dreq = dreq;
+}
+inline void channel_config_set_read_increment(dma_channel_config* c,
+                                              bool incr) {
+  c->read_increment = incr;
+}
+inline void channel_config_set_write_increment(dma_channel_config* c,
+                                               bool incr) {
+  c->write_increment = incr;
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config* config,
+                           volatile void* write_addr,
+                           const volatile void* read_addr,
+                           uint transfer_count, bool trigger);
+
+// Transfers paced by an SPI TX DREQ are delivered to that SPI instance and
+// complete after the corresponding simulated time; others complete at once.
+void dma_channel_transfer_from_buffer_now(uint channel,
+                                          const volatile void* read_addr,
+                                          std::uint32_t transfer_count);
+
+bool dma_channel_is_busy(uint channel);
+void dma_channel_wait_for_finish_blocking(uint channel);
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled);
+bool dma_channel_get_irq0_status(uint channel);
+void dma_channel_acknowledge_irq0(uint channel);
@@ -0,0 +1,25 @@
+#pragma once
+
+#include "pico/types.h"
+
+enum irq_num_rp2040 {
+  PIO0_IRQ_0 = 7,
+  PIO0_IRQ_1 = 8,
+  PIO1_IRQ_0 = 9,
+  PIO1_IRQ_1 = 10,
+  DMA_IRQ_0 = 11,
+  DMA_IRQ_1 = 12,
+  IO_IRQ_BANK0 = 13,
+  UART0_IRQ = 20,
+  UART1_IRQ = 21,
+  NUM_IRQS = 32,
+};
+
+#define PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY 0x80
+
+void irq_set_enabled(uint num, bool enabled);
+bool irq_is_enabled(uint num);
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_add_shared_handler(uint num, irq_handler_t handler,
+                            std::uint8_t order_priority);
+void irq_remove_handler(uint num, irq_handler_t handler);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "hardware/gpio.h"
+#include "pico/types.h"
+
+// State machines don't execute programs in the simulation. Words written to a
+// TX FIFO are recorded (see host/sim.h), and the RX FIFO is fed by the
+// simulation driver, or by a model of the program it would run.
+
+typedef struct pio_hw pio_hw_t;
+typedef pio_hw_t* PIO;
+
+extern pio_hw_t* const pio0;
+extern pio_hw_t* const pio1;
+
+#define NUM_PIO_STATE_MACHINES 4
+
+typedef struct pio_program {
+  const std::uint16_t* instructions;
+  std::uint8_t length;
+  std::int8_t origin;
+} pio_program_t;
+
+typedef struct {
+  std::uint32_t clkdiv;
+  std::uint32_t execctrl;
+  std::uint32_t shiftctrl;
+  std::uint32_t pinctrl;
+} pio_sm_config;
+
+int pio_claim_unused_sm(PIO pio, bool required);
+void pio_sm_unclaim(PIO pio, uint sm);
+uint pio_add_program(PIO pio, const pio_program_t* program);
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled);
+void pio_sm_clear_fifos(PIO pio, uint sm);
+
+void pio_sm_put(PIO pio, uint sm, std::uint32_t data);
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm);
+inline void pio_sm_put_blocking(PIO pio, uint sm, std::uint32_t data) {
+  pio_sm_put(pio, sm, data);
+}
+
+std::uint32_t pio_sm_get(PIO pio, uint sm);
+// With an empty RX FIFO, returns what the program model would push next, and
+// panics if there is none.
+std::uint32_t pio_sm_get_blocking(PIO pio, uint sm);
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm);
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm);
+
+// Models quadrature_encoder.pio on a state machine: pushes the quarter-step
+// count of the given pins, updated as they are driven.
+void pio_sim_run_quadrature_encoder(PIO pio, uint sm, uint pin_a, uint pin_b);
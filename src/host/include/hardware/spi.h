@@ -0,0 +1,23 @@
+#pragma once
+
+#include "pico/types.h"
+
+typedef struct spi_hw {
+  volatile std::uint32_t dr;
+} spi_hw_t;
+
+typedef struct spi_inst spi_inst_t;
+
+extern spi_inst_t* const spi0;
+extern spi_inst_t* const spi1;
+
+uint spi_init(spi_inst_t* spi, uint baudrate);
+void spi_deinit(spi_inst_t* spi);
+
+spi_hw_t* spi_get_hw(spi_inst_t* spi);
+uint spi_get_dreq(spi_inst_t* spi, bool is_tx);
+
+// Transfers take simulated time according to the baud rate.
+int spi_write_blocking(spi_inst_t* spi, const std::uint8_t* src,
+                       std::size_t len);
+bool spi_is_busy(const spi_inst_t* spi);
@@ -0,0 +1,13 @@
+#pragma once
+
+#include "pico/types.h"
+
+uint next_striped_spin_lock_num();
+
+inline std::uint32_t save_and_disable_interrupts() { return 0; }
+inline void restore_interrupts(std::uint32_t status) {}
+
+inline void __dmb() {}
+inline void __sev() {}
+inline void __wfe() {}
+inline void __compiler_memory_barrier() {}
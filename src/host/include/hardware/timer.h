@@ -0,0 +1,8 @@
+#pragma once
+
+#include "pico/time.h"
+
+inline std::uint64_t time_us_64() { return get_absolute_time(); }
+inline std::uint32_t time_us_32() {
+  return static_cast<std::uint32_t>(time_us_64());
+}
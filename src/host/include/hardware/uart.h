@@ -0,0 +1,37 @@
+#pragma once
+
+#include "pico/types.h"
+
+typedef struct uart_inst uart_inst_t;
+
+extern uart_inst_t* const uart0;
+extern uart_inst_t* const uart1;
+
+uart_inst_t* uart_get_instance(uint num);
+uint uart_get_index(uart_inst_t* uart);
+
+enum uart_parity_t {
+  UART_PARITY_NONE,
+  UART_PARITY_EVEN,
+  UART_PARITY_ODD,
+};
+
+uint uart_init(uart_inst_t* uart, uint baudrate);
+void uart_deinit(uart_inst_t* uart);
+void uart_set_format(uart_inst_t* uart, uint data_bits, uint stop_bits,
+                     uart_parity_t parity);
+void uart_set_fifo_enabled(uart_inst_t* uart, bool enabled);
+// RX interrupts are raised for each byte delivered by sim::UartReceive(). TX
+// interrupts are raised whenever the TX FIFO drains to half full or below.
+void uart_set_irq_enables(uart_inst_t* uart, bool rx_has_data,
+                          bool tx_needs_data);
+
+bool uart_is_readable(uart_inst_t* uart);
+char uart_getc(uart_inst_t* uart);
+// Written bytes are shifted out of a 32-byte TX FIFO at the baud rate and
+// handed to the observer as they leave. uart_write_blocking() advances
+// simulated time while the FIFO is full.
+bool uart_is_writable(uart_inst_t* uart);
+void uart_putc_raw(uart_inst_t* uart, char c);
+void uart_write_blocking(uart_inst_t* uart, const std::uint8_t* src,
+                         std::size_t len);
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "pico/types.h"
+
+inline bool watchdog_enable_caused_reboot() { return false; }
+inline void watchdog_enable(std::uint32_t delay_ms, bool pause_on_debug) {}
+inline void watchdog_update() {}
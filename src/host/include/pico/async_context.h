@@ -0,0 +1,58 @@
+#pragma once
+
+#include "pico/time.h"
+
+typedef struct async_context async_context_t;
+
+typedef struct async_when_pending_worker {
+  struct async_when_pending_worker* next;
+  void (*do_work)(async_context_t* context,
+                  struct async_when_pending_worker* worker);
+  volatile bool work_pending;
+  void* user_data;
+} async_when_pending_worker_t;
+
+typedef struct async_work_on_timeout {
+  struct async_work_on_timeout* next;
+  void (*do_work)(async_context_t* context,
+                  struct async_work_on_timeout* worker);
+  absolute_time_t next_time;
+  void* user_data;
+} async_at_time_worker_t;
+
+struct async_context {
+  async_when_pending_worker_t* when_pending_list;
+  async_at_time_worker_t* at_time_list;
+};
+
+bool async_context_add_when_pending_worker(
+    async_context_t* context, async_when_pending_worker_t* worker);
+bool async_context_remove_when_pending_worker(
+    async_context_t* context, async_when_pending_worker_t* worker);
+void async_context_set_work_pending(async_context_t* context,
+                                    async_when_pending_worker_t* worker);
+
+bool async_context_add_at_time_worker_at(async_context_t* context,
+                                         async_at_time_worker_t* worker,
+                                         absolute_time_t at);
+bool async_context_add_at_time_worker_in_ms(async_context_t* context,
+                                            async_at_time_worker_t* worker,
+                                            std::uint32_t ms);
+bool async_context_remove_at_time_worker(async_context_t* context,
+                                         async_at_time_worker_t* worker);
+
+// Runs all pending and due workers.
+void async_context_poll(async_context_t* context);
+
+// Advances simulated time until work is pending or `until` is reached.
+void async_context_wait_for_work_until(async_context_t* context,
+                                       absolute_time_t until);
+
+inline void async_context_acquire_lock_blocking(async_context_t* context) {}
+inline void async_context_release_lock(async_context_t* context) {}
+
+inline std::uint32_t async_context_execute_sync(
+    async_context_t* context, std::uint32_t (*func)(void* param),
+    void* param) {
+  return func(param);
+}
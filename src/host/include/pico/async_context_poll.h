@@ -0,0 +1,15 @@
+#pragma once
+
+#include "pico/async_context.h"
+
+typedef struct async_context_poll {
+  async_context_t core;
+} async_context_poll_t;
+
+inline bool async_context_poll_init_with_defaults(
+    async_context_poll_t* self) {
+  *self = {};
+  return true;
+}
+
+inline void async_context_deinit(async_context_t* context) {}
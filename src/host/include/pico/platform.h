@@ -0,0 +1,7 @@
+#pragma once
+
+#include "pico/types.h"
+
+[[noreturn]] void panic(const char* fmt, ...);
+
+uint get_core_num();
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "hardware/gpio.h"
+#include "pico/platform.h"
+#include "pico/time.h"
+
+inline bool stdio_init_all() { return true; }
+inline bool stdio_usb_init() { return true; }
+
+// No console input in the simulation.
+inline constexpr int PICO_ERROR_TIMEOUT = -1;
+inline int getchar_timeout_us(std::uint32_t timeout_us) {
+  return PICO_ERROR_TIMEOUT;
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "hardware/sync.h"
+#include "pico/types.h"
+
+// The simulation is single-threaded, so locks never contend.
+
+typedef struct critical_section {
+  uint spin_lock_num;
+} critical_section_t;
+
+inline void critical_section_init_with_lock_num(critical_section_t* crit_sec,
+                                                uint lock_num) {
+  crit_sec->spin_lock_num = lock_num;
+}
+inline void critical_section_init(critical_section_t* crit_sec) {
+  critical_section_init_with_lock_num(crit_sec, next_striped_spin_lock_num());
+}
+inline void critical_section_enter_blocking(critical_section_t* crit_sec) {}
+inline void critical_section_exit(critical_section_t* crit_sec) {}
+inline void critical_section_deinit(critical_section_t* crit_sec) {}
+
+typedef struct semaphore {
+  std::int16_t permits;
+  std::int16_t max_permits;
+} semaphore_t;
+
+inline void sem_init(semaphore_t* sem, std::int16_t initial_permits,
+                     std::int16_t max_permits) {
+  *sem = {.permits = initial_permits, .max_permits = max_permits};
+}
+inline int sem_available(semaphore_t* sem) { return sem->permits; }
+inline bool sem_release(semaphore_t* sem) {
+  if (sem->permits == sem->max_permits) {
+    return false;
+  }
+  ++sem->permits;
+  return true;
+}
+void sem_acquire_blocking(semaphore_t* sem);
+
+typedef struct mutex {
+  uint owner;
+} mutex_t;
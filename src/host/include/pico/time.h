@@ -0,0 +1,54 @@
+#pragma once
+
+#include "pico/types.h"
+
+inline constexpr absolute_time_t at_the_end_of_time = UINT64_MAX;
+inline constexpr absolute_time_t nil_time = 0;
+
+inline bool is_nil_time(absolute_time_t t) { return t == nil_time; }
+
+inline std::uint64_t to_us_since_boot(absolute_time_t t) { return t; }
+inline absolute_time_t from_us_since_boot(std::uint64_t us) { return us; }
+
+absolute_time_t get_absolute_time();
+
+inline absolute_time_t delayed_by_us(absolute_time_t t, std::uint64_t us) {
+  return t + us;
+}
+inline absolute_time_t delayed_by_ms(absolute_time_t t, std::uint32_t ms) {
+  return t + std::uint64_t{ms} * 1000;
+}
+inline absolute_time_t make_timeout_time_us(std::uint64_t us) {
+  return delayed_by_us(get_absolute_time(), us);
+}
+inline absolute_time_t make_timeout_time_ms(std::uint32_t ms) {
+  return delayed_by_ms(get_absolute_time(), ms);
+}
+inline std::int64_t absolute_time_diff_us(absolute_time_t from,
+                                          absolute_time_t to) {
+  return static_cast<std::int64_t>(to - from);
+}
+
+// Sleeping advances simulated time, firing any alarms and events due in the
+// meantime.
+void sleep_us(std::uint64_t us);
+void sleep_ms(std::uint32_t ms);
+
+typedef std::int32_t alarm_id_t;
+typedef std::int64_t (*alarm_callback_t)(alarm_id_t id, void* user_data);
+typedef struct alarm_pool alarm_pool_t;
+
+alarm_pool_t* alarm_pool_get_default();
+alarm_id_t alarm_pool_add_alarm_at(alarm_pool_t* pool, absolute_time_t time,
+                                   alarm_callback_t callback, void* user_data,
+                                   bool fire_if_past);
+bool alarm_pool_cancel_alarm(alarm_pool_t* pool, alarm_id_t alarm_id);
+
+inline alarm_id_t add_alarm_at(absolute_time_t time, alarm_callback_t callback,
+                               void* user_data, bool fire_if_past) {
+  return alarm_pool_add_alarm_at(alarm_pool_get_default(), time, callback,
+                                 user_data, fire_if_past);
+}
+inline bool cancel_alarm(alarm_id_t alarm_id) {
+  return alarm_pool_cancel_alarm(alarm_pool_get_default(), alarm_id);
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+// Host stand-in for the Pico SDK. Only the subset of the API used by the
+// firmware is provided; see host/sim.h for driving the simulation.
+
+#include <cstddef>
+#include <cstdint>
+
+typedef unsigned int uint;
+
+// Microseconds since boot in simulated time.
+typedef std::uint64_t absolute_time_t;
+
+typedef void (*irq_handler_t)(void);
+
+#define __not_in_flash_func(func_name) func_name
+#define __time_critical_func(func_name) func_name
@@ -0,0 +1,18 @@
+#pragma once
+
+// Host stand-in for the header pioasm generates from quadrature_encoder.pio.
+// The simulation decodes the pins itself rather than running the program.
+
+#include "hardware/pio.h"
+
+static const pio_program_t quadrature_encoder_program = {
+    .instructions = nullptr,
+    .length = 28,
+    .origin = 0,
+};
+
+static inline void quadrature_encoder_program_init(PIO pio, uint sm,
+                                                   uint offset, uint pin_a,
+                                                   uint pin_b) {
+  pio_sim_run_quadrature_encoder(pio, sm, pin_a, pin_b);
+}
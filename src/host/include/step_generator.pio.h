@@ -0,0 +1,19 @@
+#pragma once
+
+// Host stand-in for the header pioasm generates from step_generator.pio. Keep
+// the constants in sync with that program.
+
+#include "hardware/pio.h"
+
+static const pio_program_t step_generator_program = {
+    .instructions = nullptr,
+    .length = 10,
+    .origin = -1,
+};
+
+static const std::uint32_t step_generator_overhead_cycles = 9;
+
+static inline void step_generator_program_init(PIO pio, uint sm, uint offset,
+                                               uint pin) {
+  pio_sm_put(pio, sm, 0);
+}
@@ -0,0 +1,137 @@
+// Exercises the Modbus RTU master against a simulated drive. Reads and writes
+// single registers and whole parameter pages, checks the values that come back
+// and reports how long each transaction takes in simulated time. Also checks
+// that a request with nobody listening times out, and that corrupt, mismatched
+// and exception responses are reported as such.
+
+#include <pico/async_context_poll.h>
+
+#include <array>
+#include <cstdint>
+#include <iostream>
+
+#include "host/fake_drive.h"
+#include "host/sim.h"
+#include "modbus.h"
+#include "picoro/task.h"
+
+namespace {
+
+int failures = 0;
+
+void Check(bool condition, const char* description) {
+  std::cout << (condition ? "ok: " : "FAILED: ") << description << std::endl;
+  if (!condition) {
+    ++failures;
+  }
+}
+
+// Largest page in motor_programmer/parameters.py.
+constexpr std::uint16_t kPageStart = 125;
+constexpr std::size_t kPageSize = 48;
+
+Task Exercise(Modbus drive, Modbus unconnected, FakeDrive& fake_drive,
+              bool& done) {
+  std::uint64_t start = sim::Now();
+  const auto initial = co_await drive.Read(7);
+  Check(initial == 1007, "unwritten register reads as 1000 + address");
+  std::cout << "read took " << sim::Now() - start << "us" << std::endl;
+
+  start = sim::Now();
+  const auto written = co_await drive.Write(7, 0xBEEF);
+  Check(written.has_value(), "write is acknowledged");
+  std::cout << "write took " << sim::Now() - start << "us" << std::endl;
+
+  const auto read_back = co_await drive.Read(7);
+  Check(read_back == 0xBEEF, "written value reads back");
+
+  const auto other = co_await drive.Read(8);
+  Check(other == 1008, "neighbouring register is unaffected");
+
+  std::array<std::uint16_t, kPageSize> page;
+  std::size_t requests = fake_drive.Requests();
+  start = sim::Now();
+  const auto page_read = co_await drive.ReadRange(kPageStart, page);
+  Check(page_read.has_value() && page.front() == 1000 + kPageStart &&
+            page.back() == 1000 + kPageStart + kPageSize - 1,
+        "page reads in one range");
+  Check(fake_drive.Requests() == requests + 1, "page read is one request");
+  std::cout << "page read took " << sim::Now() - start << "us" << std::endl;
+
+  for (std::size_t i = 0; i < page.size(); ++i) {
+    page[i] = 2 * i;
+  }
+  requests = fake_drive.Requests();
+  start = sim::Now();
+  const auto page_written = co_await drive.WriteRange(kPageStart, page);
+  Check(page_written.has_value(), "page write is acknowledged");
+  Check(fake_drive.Requests() == requests + 1, "page write is one request");
+  std::cout << "page write took " << sim::Now() - start << "us" << std::endl;
+
+  page.fill(0);
+  const auto page_read_back = co_await drive.ReadRange(kPageStart, page);
+  bool matches = page_read_back.has_value();
+  for (std::size_t i = 0; i < page.size(); ++i) {
+    matches = matches && page[i] == 2 * i;
+  }
+  Check(matches, "written page reads back");
+  const auto past_page = co_await drive.Read(kPageStart + kPageSize);
+  Check(past_page == 1000 + kPageStart + kPageSize,
+        "register past the page is unaffected");
+
+  start = sim::Now();
+  const auto timed_out = co_await unconnected.Read(0);
+  Check(!timed_out && timed_out.error() == Modbus::Error::kTimeout,
+        "request without a drive times out");
+  std::cout << "timeout took " << sim::Now() - start << "us" << std::endl;
+
+  fake_drive.SetFaults({.corrupt_checksum = true});
+  const auto corrupt = co_await drive.Read(7);
+  Check(!corrupt && corrupt.error() == Modbus::Error::kChecksum,
+        "response with a bad checksum is rejected");
+
+  fake_drive.SetFaults({.wrong_address = true});
+  const auto mismatched = co_await drive.Read(7);
+  Check(!mismatched && mismatched.error() == Modbus::Error::kUnexpectedResponse,
+        "response from another address is rejected");
+
+  // Illegal data address.
+  fake_drive.SetFaults({.exception_code = 2});
+  const auto exception = co_await drive.ReadRange(kPageStart, page);
+  Check(!exception && exception.error() == Modbus::Error::kException,
+        "exception response is reported");
+  start = sim::Now();
+  const auto write_exception = co_await drive.Write(7, 1);
+  Check(!write_exception &&
+            write_exception.error() == Modbus::Error::kException,
+        "exception response to a write is reported without a timeout");
+  std::cout << "exception took " << sim::Now() - start << "us" << std::endl;
+
+  fake_drive.SetFaults({});
+  const auto recovered = co_await drive.Read(7);
+  Check(recovered == 0xBEEF, "drive is readable again after the faults");
+
+  done = true;
+}
+
+}  // namespace
+
+int main() {
+  // Static so that it outlives the drivers' static interrupt state, which
+  // unregisters from it on exit.
+  static async_context_poll_t poll_context;
+  async_context_poll_init_with_defaults(&poll_context);
+  async_context_t& context = poll_context.core;
+
+  FakeDrive fake_drive(uart1);
+  Modbus drive = Modbus::Create<1>(context, {.tx = 4, .rx = 5});
+  Modbus unconnected = Modbus::Create<0>(context, {.tx = 0, .rx = 1});
+
+  bool done = false;
+  Task task = Exercise(drive, unconnected, fake_drive, done);
+  while (!done) {
+    async_context_poll(&context);
+    async_context_wait_for_work_until(&context, at_the_end_of_time);
+  }
+  return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,153 @@
+// Checks the velocity profiles Ramp produces with the controller's limits,
+// from one random target to another: the acceleration and jerk implied by the
+// commanded velocities stay within the limits, except when skipping the band
+// below the start velocity, and the velocity never overshoots. Also reports
+// the host wall-clock time per Step().
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+#include "ramp.h"
+
+namespace {
+
+// As in Controller.
+constexpr Ramp::Limits kLimits = {.start_velocity = 1'000,
+                                  .max_acceleration = 400'000,
+                                  .max_jerk = 4'000'000};
+constexpr double kDt = 1e-3;
+// Rounding allowance when comparing against the limits.
+constexpr double kTolerance = 1e-6;
+// Far longer than any ramp between the targets below should take.
+constexpr int kMaxTicks = 10'000;
+
+struct Worst {
+  double acceleration = 0;
+  double jerk = 0;
+};
+
+// Velocity from about 1 to 2^18 steps/s, log-uniform, of either sign, or
+// zero.
+double RandomTarget(std::mt19937& random) {
+  std::uniform_real_distribution<double> exponent(0, 18);
+  const double magnitude =
+      random() % 16 == 0 ? 0 : std::round(std::exp2(exponent(random)));
+  return random() % 2 ? magnitude : -magnitude;
+}
+
+// True if a step from `from` to `to` touches or skips the start velocity band.
+bool InBand(double from, double to) {
+  const double start = kLimits.start_velocity;
+  return std::abs(from) <= start || std::abs(to) <= start ||
+         (from < 0) != (to < 0);
+}
+
+// Ramps from `from`, which has been reached, to `to`. Returns false if a limit
+// is exceeded or the ramp doesn't finish.
+bool Check(double from, double to, Worst& worst) {
+  Ramp ramp(kLimits);
+  ramp.SetTarget(from);
+  for (int tick = 0; tick < kMaxTicks && !ramp.Done(); ++tick) {
+    ramp.Step(kDt);
+  }
+  ramp.SetTarget(to);
+
+  bool ok = true;
+  const auto fail = [&](int tick, const char* what, double value) {
+    std::cerr << from << " -> " << to << ": " << what << " " << value
+              << " at tick " << tick << std::endl;
+    ok = false;
+  };
+  const auto check_jerk = [&](int tick, double jerk) {
+    worst.jerk = std::max(worst.jerk, std::abs(jerk) / kLimits.max_jerk);
+    if (std::abs(jerk) > kLimits.max_jerk * (1 + kTolerance)) {
+      fail(tick, "jerk", jerk);
+    }
+  };
+  double velocity = ramp.Velocity();
+  double acceleration = 0;
+  // Whether the previous tick's acceleration came from a band skip.
+  bool previous_in_band = false;
+  int tick = 0;
+  for (; tick < kMaxTicks && !ramp.Done(); ++tick) {
+    const double next = ramp.Step(kDt);
+    const double next_acceleration = (next - velocity) / kDt;
+    const bool in_band = InBand(velocity, next);
+    if (!in_band) {
+      worst.acceleration = std::max(worst.acceleration,
+                                    std::abs(next_acceleration) /
+                                        kLimits.max_acceleration);
+      if (std::abs(next_acceleration) >
+          kLimits.max_acceleration * (1 + kTolerance)) {
+        fail(tick, "acceleration", next_acceleration);
+      }
+    }
+    if (!in_band && !previous_in_band) {
+      check_jerk(tick, (next_acceleration - acceleration) / kDt);
+    }
+    if (next < std::min(from, to) || next > std::max(from, to)) {
+      fail(tick, "overshoot to", next);
+    }
+    velocity = next;
+    acceleration = next_acceleration;
+    previous_in_band = in_band;
+  }
+  if (!ramp.Done()) {
+    fail(tick, "unfinished at", velocity);
+  }
+  // Coming to rest is the last change of acceleration.
+  if (!previous_in_band) {
+    check_jerk(tick, -acceleration / kDt);
+  }
+  return ok;
+}
+
+// Keeps the compiler from discarding the results.
+volatile double sink;
+
+}  // namespace
+
+int main() {
+  std::mt19937 random(1);
+  constexpr int kPairs = 20'000;
+  int failures = 0;
+  Worst worst;
+  for (int i = 0; i < kPairs; ++i) {
+    const double from = RandomTarget(random);
+    const double to = RandomTarget(random);
+    if (!Check(from, to, worst)) {
+      ++failures;
+    }
+  }
+  // The case that exposed the reversal bug.
+  if (!Check(191'370, -12'414, worst)) {
+    ++failures;
+  }
+  std::cout << "Checked " << kPairs + 1 << " ramps, " << failures
+            << " failures" << std::endl;
+  std::cout << std::fixed << std::setprecision(3)
+            << "Worst fraction of limit: acceleration " << worst.acceleration
+            << ", jerk " << worst.jerk << std::endl;
+
+  using Clock = std::chrono::steady_clock;
+  constexpr int kSteps = 1'000'000;
+  Ramp ramp(kLimits);
+  ramp.SetTarget(200'000);
+  const auto start = Clock::now();
+  for (int i = 0; i < kSteps; ++i) {
+    if (ramp.Done()) {
+      ramp.SetTarget(-ramp.Target());
+    }
+    sink = ramp.Step(kDt);
+  }
+  std::cout << std::setprecision(1) << "Host ns per Step(): "
+            << std::chrono::duration<double, std::nano>(Clock::now() - start)
+                       .count() /
+                   kSteps
+            << std::endl;
+  return failures == 0 ? 0 : 1;
+}
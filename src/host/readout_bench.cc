@@ -0,0 +1,104 @@
+// Compares FormatReadout() with the ostringstream formatting the speed readout
+// used before, in host wall-clock time and heap allocations per call, and
+// checks its digits against snprintf(). On the RP2040 the stream version also
+// pulls in the locale machinery and soft-float formatting.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "fixed_exp2.h"
+#include "readout.h"
+
+namespace {
+
+std::uint64_t allocations = 0;
+
+// The formatting draw_speed() used.
+std::string StreamFormat(double value) {
+  std::ostringstream ss;
+  if (value > 1000) {
+    ss << int(value) << ".";
+  } else if (value > 1) {
+    ss << std::setprecision(4) << value;
+  } else {
+    ss << std::setprecision(3) << value;
+  }
+  return ss.str();
+}
+
+// Keeps the compiler from discarding the results.
+volatile char sink;
+
+template <typename F>
+void Time(const char* name, const std::vector<Q32>& values, F f) {
+  using Clock = std::chrono::steady_clock;
+  const std::uint64_t start_allocations = allocations;
+  const auto start = Clock::now();
+  for (Q32 value : values) {
+    sink = f(value);
+  }
+  const auto elapsed = Clock::now() - start;
+  std::cout << std::setw(8) << name << std::fixed << std::setprecision(1)
+            << std::setw(10)
+            << std::chrono::duration<double, std::nano>(elapsed).count() /
+                   values.size()
+            << std::setw(14)
+            << double(allocations - start_allocations) / values.size()
+            << std::endl;
+}
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+  ++allocations;
+  if (void* p = std::malloc(size)) {
+    return p;
+  }
+  std::abort();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+int main() {
+  // Readouts from 0.01 to 5000, spread evenly in log scale like the levels.
+  std::mt19937 random(1);
+  std::uniform_int_distribution<std::int64_t> level(-7 * kStepsPerOctave,
+                                                    12 * kStepsPerOctave);
+  std::vector<Q32> values(100'000);
+  for (Q32& value : values) {
+    // Offset from the level's exact rate, so that ties are vanishingly rare.
+    value = LevelToQ32(level(random)) + random() % 1'000;
+  }
+
+  bool ok = true;
+  for (Q32 value : values) {
+    const double x = ToDouble(value);
+    const int decimals = x < 9.9995 ? 3 : x < 99.995 ? 2 : x < 999.95 ? 1 : 0;
+    char expected[16];
+    std::snprintf(expected, sizeof(expected), decimals ? "%.*f" : "%.*f.",
+                  decimals, x);
+    if (FormatReadout(value).View() != expected) {
+      std::cerr << x << ": got " << FormatReadout(value).View()
+                << ", expected " << expected << std::endl;
+      ok = false;
+    }
+  }
+
+  std::cout << std::setw(8) << "format" << std::setw(10) << "host ns"
+            << std::setw(14) << "allocations" << std::endl;
+  Time("stream", values,
+       [](Q32 value) { return StreamFormat(ToDouble(value))[0]; });
+  Time("readout", values,
+       [](Q32 value) { return FormatReadout(value).chars[0]; });
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+// Compares the cost of waking one coroutine out of many, with each executor
+// registering its own async_context worker as AsyncExecutor used to, against
+// the shared Scheduler's ready queue. Times are host wall-clock time per
+// wakeup, including one async_context_poll(), so they show how each design
+// scales with the number of tasks rather than what a wakeup costs on the
+// RP2040.
+
+#include <pico/async_context_poll.h>
+
+#include <chrono>
+#include <coroutine>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+#include "picoro/async.h"
+#include "picoro/task.h"
+
+namespace {
+
+// AsyncExecutor before the Scheduler: one when-pending worker per executor,
+// all of which the context walks on every poll.
+class WorkerExecutor {
+ public:
+  WorkerExecutor(async_context_t& context)
+      : state_({.worker = {.do_work = &ResumeInContext, .work_pending = false},
+                .context = context}) {
+    async_context_add_when_pending_worker(&state_.context, &state_.worker);
+  }
+
+  ~WorkerExecutor() {
+    async_context_remove_when_pending_worker(&state_.context, &state_.worker);
+  }
+
+  void operator=(const WorkerExecutor&) = delete;
+
+  void Schedule(std::coroutine_handle<> handle) {
+    state_.handle = handle;
+    async_context_set_work_pending(&state_.context, &state_.worker);
+  }
+
+ private:
+  struct WorkerState {
+    async_when_pending_worker_t worker;
+    async_context_t& context;
+    std::coroutine_handle<> handle;
+  };
+
+  static void ResumeInContext(async_context_t* context,
+                              async_when_pending_worker_t* worker) {
+    reinterpret_cast<WorkerState&>(*worker).handle.resume();
+  }
+
+  WorkerState state_;
+};
+
+// Suspends the current coroutine, handing its handle to the benchmark.
+struct Park : std::suspend_always {
+  std::coroutine_handle<>& handle;
+
+  void await_suspend(std::coroutine_handle<> handle) { this->handle = handle; }
+};
+
+Task Sleeper(std::coroutine_handle<>& handle, std::uint64_t& resumes) {
+  while (true) {
+    co_await Park{.handle = handle};
+    ++resumes;
+  }
+}
+
+constexpr int kWakeups = 20'000;
+
+// Wakes each of `task_count` parked tasks in turn through its own `Executor`
+// and returns the mean time per wakeup in nanoseconds.
+template <typename Executor>
+double NsPerWakeup(async_context_t& context, int task_count) {
+  // Neither executor type is moveable.
+  std::deque<Executor> executors;
+  std::vector<std::coroutine_handle<>> handles(task_count);
+  std::vector<Task> tasks;
+  std::uint64_t resumes = 0;
+  for (int i = 0; i < task_count; ++i) {
+    executors.emplace_back(context);
+    tasks.push_back(Sleeper(handles[i], resumes));
+  }
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kWakeups; ++i) {
+    const int task = i % task_count;
+    executors[task].Schedule(handles[task]);
+    async_context_poll(&context);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  if (resumes != kWakeups) {
+    std::cerr << "Expected " << kWakeups << " resumptions, got " << resumes
+              << std::endl;
+    std::exit(1);
+  }
+  return std::chrono::duration<double, std::nano>(elapsed).count() /
+         kWakeups;
+}
+
+}  // namespace
+
+int main() {
+  // Static so that it outlives the scheduler, which unregisters from it on
+  // exit.
+  static async_context_poll_t poll_context;
+  async_context_poll_init_with_defaults(&poll_context);
+  async_context_t& context = poll_context.core;
+
+  std::cout << "Host ns per wakeup:" << std::endl;
+  std::cout << std::setw(8) << "tasks" << std::setw(14) << "per-worker"
+            << std::setw(14) << "scheduler" << std::endl;
+  for (int task_count : {1, 8, 64, 512}) {
+    const double workers = NsPerWakeup<WorkerExecutor>(context, task_count);
+    const double scheduler = NsPerWakeup<AsyncExecutor>(context, task_count);
+    std::cout << std::fixed << std::setprecision(0) << std::setw(8)
+              << task_count << std::setw(14) << workers << std::setw(14)
+              << scheduler << std::endl;
+  }
+  return 0;
+}
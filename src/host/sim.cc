@@ -0,0 +1,915 @@
+#include "sim.h"
+
+#include <hardware/dma.h>
+#include <hardware/gpio.h>
+#include <hardware/irq.h>
+#include <hardware/sync.h>
+#include <hardware/uart.h>
+#include <pico/async_context.h>
+#include <pico/platform.h>
+#include <pico/sync.h>
+#include <pico/time.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <map>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// Virtual clock and event queue.
+
+struct Clock {
+  std::uint64_t now = 0;
+  std::uint64_t next_sequence = 0;
+  // Keyed by (time, sequence) so that events at the same time run in the order
+  // they were scheduled.
+  std::map<std::pair<std::uint64_t, std::uint64_t>, std::function<void()>>
+      events;
+};
+
+Clock& GetClock() {
+  static Clock clock;
+  return clock;
+}
+
+using EventKey = std::pair<std::uint64_t, std::uint64_t>;
+
+EventKey ScheduleEvent(std::uint64_t time, std::function<void()> event) {
+  Clock& clock = GetClock();
+  const EventKey key = {std::max(time, clock.now), clock.next_sequence++};
+  clock.events.emplace(key, std::move(event));
+  return key;
+}
+
+std::optional<std::uint64_t> NextEventTime() {
+  const Clock& clock = GetClock();
+  if (clock.events.empty()) {
+    return std::nullopt;
+  }
+  return clock.events.begin()->first.first;
+}
+
+// Alarms.
+
+struct Alarm {
+  EventKey key;
+  alarm_callback_t callback;
+  void* user_data;
+};
+
+std::map<alarm_id_t, Alarm>& Alarms() {
+  static std::map<alarm_id_t, Alarm> alarms;
+  return alarms;
+}
+
+void ScheduleAlarm(alarm_id_t id, absolute_time_t time) {
+  Alarm& alarm = Alarms().at(id);
+  alarm.key = ScheduleEvent(time, [id, time] {
+    const Alarm alarm = Alarms().at(id);
+    const std::int64_t result = alarm.callback(id, alarm.user_data);
+    if (!Alarms().contains(id)) {
+      return;
+    }
+    if (result > 0) {
+      ScheduleAlarm(id, time + result);
+    } else if (result < 0) {
+      ScheduleAlarm(id, sim::Now() - result);
+    } else {
+      Alarms().erase(id);
+    }
+  });
+}
+
+// Interrupts.
+
+struct Irq {
+  bool enabled = false;
+  std::vector<irq_handler_t> handlers;
+};
+
+std::array<Irq, NUM_IRQS>& Irqs() {
+  static std::array<Irq, NUM_IRQS> irqs;
+  return irqs;
+}
+
+// GPIO.
+
+struct Pin {
+  gpio_function function = GPIO_FUNC_NULL;
+  bool is_output = false;
+  bool output = false;
+  bool pull_up = false;
+  std::optional<bool> driven;
+  std::uint32_t irq_enabled = 0;
+  std::uint32_t irq_events = 0;
+
+  bool Level() const {
+    if (is_output) {
+      return output;
+    }
+    return driven.value_or(pull_up);
+  }
+};
+
+std::array<Pin, NUM_BANK0_GPIOS>& Pins() {
+  static std::array<Pin, NUM_BANK0_GPIOS> pins;
+  return pins;
+}
+
+// State machines running quadrature_encoder.pio, which is modelled here.
+
+struct QuadratureDecoder {
+  PIO pio;
+  uint sm;
+  std::array<uint, 2> pins;
+  // `BA` pin levels as of the last update.
+  unsigned state;
+  std::uint32_t count = 0;
+
+  unsigned ReadPins() const {
+    return (Pins().at(pins[1]).Level() << 1) | Pins().at(pins[0]).Level();
+  }
+
+  // Mirrors the program's jump table.
+  void Update() {
+    constexpr std::array<int, 16> kIncrements = {
+        0, -1, +1, 0, +1, 0, 0, -1, -1, 0, 0, +1, 0, +1, -1, 0};
+    const unsigned next = ReadPins();
+    count += kIncrements[(state << 2) | next];
+    state = next;
+  }
+};
+
+std::vector<QuadratureDecoder>& QuadratureDecoders() {
+  static std::vector<QuadratureDecoder> decoders;
+  return decoders;
+}
+
+std::function<void(spi_inst_t*, std::span<const std::uint8_t>)>&
+SpiObserver() {
+  static std::function<void(spi_inst_t*, std::span<const std::uint8_t>)>
+      observer;
+  return observer;
+}
+
+std::function<void(uart_inst_t*, std::span<const std::uint8_t>)>&
+UartObserver() {
+  static std::function<void(uart_inst_t*, std::span<const std::uint8_t>)>
+      observer;
+  return observer;
+}
+
+std::function<void(PIO, unsigned, std::uint32_t)>& PioObserver() {
+  static std::function<void(PIO, unsigned, std::uint32_t)> observer;
+  return observer;
+}
+
+// Duration of an SPI transfer in simulated microseconds, rounded up.
+std::uint64_t TransferTimeUs(uint baudrate, std::size_t bytes) {
+  if (baudrate == 0) {
+    return 0;
+  }
+  return (std::uint64_t{bytes} * 8 * 1'000'000 + baudrate - 1) / baudrate;
+}
+
+// Async context helpers.
+
+async_at_time_worker_t* NextDueWorker(async_context_t* context) {
+  for (auto* worker = context->at_time_list; worker; worker = worker->next) {
+    if (worker->next_time <= sim::Now()) {
+      return worker;
+    }
+  }
+  return nullptr;
+}
+
+bool HasPendingWork(async_context_t* context) {
+  for (auto* worker = context->when_pending_list; worker;
+       worker = worker->next) {
+    if (worker->work_pending) {
+      return true;
+    }
+  }
+  return NextDueWorker(context) != nullptr;
+}
+
+bool Contains(async_when_pending_worker_t* list,
+              async_when_pending_worker_t* target) {
+  for (auto* worker = list; worker; worker = worker->next) {
+    if (worker == target) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+// Simulation control.
+
+namespace sim {
+
+std::uint64_t Now() { return GetClock().now; }
+
+void AdvanceTo(std::uint64_t time) {
+  Clock& clock = GetClock();
+  while (!clock.events.empty() && clock.events.begin()->first.first <= time) {
+    auto node = clock.events.extract(clock.events.begin());
+    clock.now = std::max(clock.now, node.key().first);
+    node.mapped()();
+  }
+  clock.now = std::max(clock.now, time);
+}
+
+void Schedule(std::uint64_t time, std::function<void()> event) {
+  ScheduleEvent(time, std::move(event));
+}
+
+void WaitForWorkUntil(std::span<async_context_t* const> contexts,
+                      std::uint64_t until) {
+  const auto has_work = [&] {
+    return std::ranges::any_of(contexts, HasPendingWork);
+  };
+  while (!has_work() && Now() < until) {
+    absolute_time_t next = until;
+    if (const auto event_time = NextEventTime()) {
+      next = std::min(next, *event_time);
+    }
+    for (async_context_t* context : contexts) {
+      if (context->at_time_list) {
+        next = std::min(next, context->at_time_list->next_time);
+      }
+    }
+    if (next == at_the_end_of_time) {
+      // Nothing will ever happen.
+      return;
+    }
+    AdvanceTo(next);
+  }
+}
+
+void DriveInput(unsigned pin, bool level) {
+  Pin& state = Pins().at(pin);
+  const bool previous = state.Level();
+  state.driven = level;
+  if (state.Level() == previous) {
+    return;
+  }
+  for (QuadratureDecoder& decoder : QuadratureDecoders()) {
+    if (decoder.pins[0] == pin || decoder.pins[1] == pin) {
+      decoder.Update();
+    }
+  }
+  const std::uint32_t event = level ? GPIO_IRQ_EDGE_RISE : GPIO_IRQ_EDGE_FALL;
+  if ((state.irq_enabled & event) == 0) {
+    return;
+  }
+  state.irq_events |= event;
+  RaiseIrq(IO_IRQ_BANK0);
+}
+
+bool PinLevel(unsigned pin) { return Pins().at(pin).Level(); }
+
+void RaiseIrq(unsigned num) {
+  const Irq& irq = Irqs().at(num);
+  if (!irq.enabled) {
+    return;
+  }
+  // Copied as handlers may be added from within a handler.
+  const std::vector<irq_handler_t> handlers = irq.handlers;
+  for (irq_handler_t handler : handlers) {
+    handler();
+  }
+}
+
+void OnPioPut(std::function<void(PIO, unsigned, std::uint32_t)> observer) {
+  PioObserver() = std::move(observer);
+}
+
+void OnSpiWrite(
+    std::function<void(spi_inst_t*, std::span<const std::uint8_t>)> observer) {
+  SpiObserver() = std::move(observer);
+}
+
+void OnUartWrite(
+    std::function<void(uart_inst_t*, std::span<const std::uint8_t>)> observer) {
+  UartObserver() = std::move(observer);
+}
+
+}  // namespace sim
+
+// pico/platform.h
+
+void panic(const char* fmt, ...) {
+  std::va_list args;
+  va_start(args, fmt);
+  std::vfprintf(stderr, fmt, args);
+  va_end(args);
+  std::fputc('\n', stderr);
+  std::abort();
+}
+
+uint get_core_num() { return 0; }
+
+// pico/time.h
+
+absolute_time_t get_absolute_time() { return sim::Now(); }
+
+void sleep_us(std::uint64_t us) { sim::AdvanceTo(sim::Now() + us); }
+
+void sleep_ms(std::uint32_t ms) { sleep_us(std::uint64_t{ms} * 1000); }
+
+struct alarm_pool {};
+
+alarm_pool_t* alarm_pool_get_default() {
+  static alarm_pool_t pool;
+  return &pool;
+}
+
+alarm_id_t alarm_pool_add_alarm_at(alarm_pool_t* pool, absolute_time_t time,
+                                   alarm_callback_t callback, void* user_data,
+                                   bool fire_if_past) {
+  static alarm_id_t next_id = 1;
+  if (time <= sim::Now()) {
+    if (!fire_if_past) {
+      return 0;
+    }
+    // As in the SDK, an alarm in the past fires immediately.
+    const std::int64_t result = callback(0, user_data);
+    if (result == 0) {
+      return 0;
+    }
+    time = result > 0 ? time + result : sim::Now() - result;
+  }
+  const alarm_id_t id = next_id++;
+  Alarms()[id] = {.callback = callback, .user_data = user_data};
+  ScheduleAlarm(id, time);
+  return id;
+}
+
+bool alarm_pool_cancel_alarm(alarm_pool_t* pool, alarm_id_t alarm_id) {
+  auto it = Alarms().find(alarm_id);
+  if (it == Alarms().end()) {
+    return false;
+  }
+  GetClock().events.erase(it->second.key);
+  Alarms().erase(it);
+  return true;
+}
+
+// pico/async_context.h
+
+bool async_context_add_when_pending_worker(
+    async_context_t* context, async_when_pending_worker_t* worker) {
+  if (Contains(context->when_pending_list, worker)) {
+    return false;
+  }
+  worker->next = context->when_pending_list;
+  context->when_pending_list = worker;
+  return true;
+}
+
+bool async_context_remove_when_pending_worker(
+    async_context_t* context, async_when_pending_worker_t* worker) {
+  for (auto** link = &context->when_pending_list; *link;
+       link = &(*link)->next) {
+    if (*link == worker) {
+      *link = worker->next;
+      return true;
+    }
+  }
+  return false;
+}
+
+void async_context_set_work_pending(async_context_t* context,
+                                    async_when_pending_worker_t* worker) {
+  worker->work_pending = true;
+}
+
+bool async_context_add_at_time_worker_at(async_context_t* context,
+                                         async_at_time_worker_t* worker,
+                                         absolute_time_t at) {
+  async_context_remove_at_time_worker(context, worker);
+  worker->next_time = at;
+  auto** link = &context->at_time_list;
+  while (*link && (*link)->next_time <= at) {
+    link = &(*link)->next;
+  }
+  worker->next = *link;
+  *link = worker;
+  return true;
+}
+
+bool async_context_add_at_time_worker_in_ms(async_context_t* context,
+                                            async_at_time_worker_t* worker,
+                                            std::uint32_t ms) {
+  return async_context_add_at_time_worker_at(context, worker,
+                                             make_timeout_time_ms(ms));
+}
+
+bool async_context_remove_at_time_worker(async_context_t* context,
+                                         async_at_time_worker_t* worker) {
+  for (auto** link = &context->at_time_list; *link; link = &(*link)->next) {
+    if (*link == worker) {
+      *link = worker->next;
+      return true;
+    }
+  }
+  return false;
+}
+
+void async_context_poll(async_context_t* context) {
+  while (auto* worker = NextDueWorker(context)) {
+    async_context_remove_at_time_worker(context, worker);
+    worker->do_work(context, worker);
+  }
+  // Like the SDK, make a single pass: workers made pending by this pass run on
+  // the next poll. Workers may be removed by earlier ones, so each is checked
+  // for membership before running.
+  std::vector<async_when_pending_worker_t*> pending;
+  for (auto* worker = context->when_pending_list; worker;
+       worker = worker->next) {
+    if (worker->work_pending) {
+      pending.push_back(worker);
+    }
+  }
+  for (auto* worker : pending) {
+    if (!Contains(context->when_pending_list, worker) ||
+        !worker->work_pending) {
+      continue;
+    }
+    worker->work_pending = false;
+    worker->do_work(context, worker);
+  }
+}
+
+void async_context_wait_for_work_until(async_context_t* context,
+                                       absolute_time_t until) {
+  sim::WaitForWorkUntil(std::span(&context, 1), until);
+}
+
+// pico/sync.h and hardware/sync.h
+
+uint next_striped_spin_lock_num() {
+  // Mirrors PICO_SPINLOCK_ID_STRIPED_FIRST..LAST.
+  static uint next = 16;
+  const uint lock_num = next;
+  next = next == 23 ? 16 : next + 1;
+  return lock_num;
+}
+
+void sem_acquire_blocking(semaphore_t* sem) {
+  if (sem->permits == 0) {
+    panic("sem_acquire_blocking would block forever");
+  }
+  --sem->permits;
+}
+
+// hardware/irq.h
+
+void irq_set_enabled(uint num, bool enabled) { Irqs().at(num).enabled = enabled; }
+
+bool irq_is_enabled(uint num) { return Irqs().at(num).enabled; }
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler) {
+  Irqs().at(num).handlers = {handler};
+}
+
+void irq_add_shared_handler(uint num, irq_handler_t handler,
+                            std::uint8_t order_priority) {
+  Irqs().at(num).handlers.push_back(handler);
+}
+
+void irq_remove_handler(uint num, irq_handler_t handler) {
+  std::erase(Irqs().at(num).handlers, handler);
+}
+
+// hardware/gpio.h
+
+void gpio_init(uint gpio) {
+  Pins().at(gpio) = {.function = GPIO_FUNC_SIO,
+                     .driven = Pins().at(gpio).driven};
+}
+
+void gpio_set_function(uint gpio, gpio_function fn) {
+  Pins().at(gpio).function = fn;
+}
+
+void gpio_set_dir(uint gpio, bool out) { Pins().at(gpio).is_output = out; }
+
+void gpio_pull_up(uint gpio) { Pins().at(gpio).pull_up = true; }
+
+void gpio_put(uint gpio, bool value) { Pins().at(gpio).output = value; }
+
+bool gpio_get(uint gpio) { return Pins().at(gpio).Level(); }
+
+std::uint32_t gpio_get_all() {
+  std::uint32_t values = 0;
+  for (uint pin = 0; pin < NUM_BANK0_GPIOS; ++pin) {
+    values |= std::uint32_t{gpio_get(pin)} << pin;
+  }
+  return values;
+}
+
+void gpio_set_irq_enabled(uint gpio, std::uint32_t event_mask, bool enabled) {
+  Pin& pin = Pins().at(gpio);
+  if (enabled) {
+    pin.irq_enabled |= event_mask;
+  } else {
+    pin.irq_enabled &= ~event_mask;
+  }
+}
+
+std::uint32_t gpio_get_irq_event_mask(uint gpio) {
+  return Pins().at(gpio).irq_events;
+}
+
+void gpio_acknowledge_irq(uint gpio, std::uint32_t event_mask) {
+  Pins().at(gpio).irq_events &= ~event_mask;
+}
+
+void gpio_add_raw_irq_handler(uint gpio, irq_handler_t handler) {
+  irq_add_shared_handler(IO_IRQ_BANK0, handler,
+                         PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+}
+
+// hardware/spi.h
+
+struct spi_inst {
+  uint index;
+  uint baudrate = 0;
+  spi_hw_t hw = {};
+};
+
+namespace {
+spi_inst spi_instances[2] = {{.index = 0}, {.index = 1}};
+}  // namespace
+
+spi_inst_t* const spi0 = &spi_instances[0];
+spi_inst_t* const spi1 = &spi_instances[1];
+
+uint spi_init(spi_inst_t* spi, uint baudrate) {
+  spi->baudrate = baudrate;
+  return baudrate;
+}
+
+void spi_deinit(spi_inst_t* spi) { spi->baudrate = 0; }
+
+spi_hw_t* spi_get_hw(spi_inst_t* spi) { return &spi->hw; }
+
+uint spi_get_dreq(spi_inst_t* spi, bool is_tx) {
+  // DREQ_SPI0_TX is 16; RX follows TX and SPI1 follows SPI0.
+  return 16 + 2 * spi->index + (is_tx ? 0 : 1);
+}
+
+int spi_write_blocking(spi_inst_t* spi, const std::uint8_t* src,
+                       std::size_t len) {
+  if (SpiObserver()) {
+    SpiObserver()(spi, {src, len});
+  }
+  sleep_us(TransferTimeUs(spi->baudrate, len));
+  return static_cast<int>(len);
+}
+
+bool spi_is_busy(const spi_inst_t* spi) { return false; }
+
+// hardware/dma.h
+
+namespace {
+struct DmaChannelState {
+  bool claimed = false;
+  dma_channel_config config = {};
+  volatile void* write_addr = nullptr;
+  bool busy = false;
+  std::uint64_t done_time = 0;
+  bool irq0_enabled = false;
+  bool irq0_status = false;
+};
+
+std::array<DmaChannelState, NUM_DMA_CHANNELS>& DmaChannels() {
+  static std::array<DmaChannelState, NUM_DMA_CHANNELS> channels;
+  return channels;
+}
+}  // namespace
+
+int dma_claim_unused_channel(bool required) {
+  auto& channels = DmaChannels();
+  for (std::size_t i = 0; i < channels.size(); ++i) {
+    if (!channels[i].claimed) {
+      channels[i].claimed = true;
+      return static_cast<int>(i);
+    }
+  }
+  if (required) {
+    panic("No DMA channels are available");
+  }
+  return -1;
+}
+
+void dma_channel_unclaim(uint channel) {
+  DmaChannels().at(channel) = {};
+}
+
+dma_channel_config dma_channel_get_default_config(uint channel) {
+  return {.size = DMA_SIZE_32,
+          .dreq = 0x3f,
+          .read_increment = true,
+          .write_increment = false};
+}
+
+void dma_channel_configure(uint channel, const dma_channel_config* config,
+                           volatile void* write_addr,
+                           const volatile void* read_addr,
+                           uint transfer_count, bool trigger) {
+  DmaChannelState& state = DmaChannels().at(channel);
+  state.config = *config;
+  state.write_addr = write_addr;
+  if (trigger) {
+    dma_channel_transfer_from_buffer_now(channel, read_addr, transfer_count);
+  }
+}
+
+void dma_channel_transfer_from_buffer_now(uint channel,
+                                          const volatile void* read_addr,
+                                          std::uint32_t transfer_count) {
+  DmaChannelState& state = DmaChannels().at(channel);
+  const std::size_t bytes = transfer_count << state.config.size;
+  std::uint64_t duration = 0;
+  for (spi_inst& spi : spi_instances) {
+    if (state.config.dreq != spi_get_dreq(&spi, true)) {
+      continue;
+    }
+    const auto* data = const_cast<const std::uint8_t*>(
+        static_cast<const volatile std::uint8_t*>(read_addr));
+    if (SpiObserver()) {
+      SpiObserver()(&spi, {data, bytes});
+    }
+    duration = TransferTimeUs(spi.baudrate, bytes);
+  }
+  state.busy = true;
+  state.done_time = sim::Now() + duration;
+  sim::Schedule(state.done_time, [channel] {
+    DmaChannelState& state = DmaChannels().at(channel);
+    state.busy = false;
+    if (state.irq0_enabled) {
+      state.irq0_status = true;
+      sim::RaiseIrq(DMA_IRQ_0);
+    }
+  });
+}
+
+bool dma_channel_is_busy(uint channel) { return DmaChannels().at(channel).busy; }
+
+void dma_channel_wait_for_finish_blocking(uint channel) {
+  const DmaChannelState& state = DmaChannels().at(channel);
+  if (state.busy) {
+    sim::AdvanceTo(state.done_time);
+  }
+}
+
+void dma_channel_set_irq0_enabled(uint channel, bool enabled) {
+  DmaChannels().at(channel).irq0_enabled = enabled;
+}
+
+bool dma_channel_get_irq0_status(uint channel) {
+  return DmaChannels().at(channel).irq0_status;
+}
+
+void dma_channel_acknowledge_irq0(uint channel) {
+  DmaChannels().at(channel).irq0_status = false;
+}
+
+// hardware/pio.h
+
+namespace {
+struct StateMachine {
+  bool claimed = false;
+  std::deque<std::uint32_t> rx;
+};
+}  // namespace
+
+struct pio_hw {
+  std::array<StateMachine, NUM_PIO_STATE_MACHINES> sms;
+  uint next_offset = 0;
+};
+
+namespace {
+pio_hw pio_instances[2];
+}  // namespace
+
+pio_hw_t* const pio0 = &pio_instances[0];
+pio_hw_t* const pio1 = &pio_instances[1];
+
+int pio_claim_unused_sm(PIO pio, bool required) {
+  for (std::size_t i = 0; i < pio->sms.size(); ++i) {
+    if (!pio->sms[i].claimed) {
+      pio->sms[i].claimed = true;
+      return static_cast<int>(i);
+    }
+  }
+  if (required) {
+    panic("No PIO state machines are available");
+  }
+  return -1;
+}
+
+void pio_sm_unclaim(PIO pio, uint sm) { pio->sms.at(sm) = {}; }
+
+uint pio_add_program(PIO pio, const pio_program_t* program) {
+  const uint offset = pio->next_offset;
+  if (program->origin >= 0 && uint(program->origin) != offset) {
+    panic("PIO program can't be loaded at its origin");
+  }
+  pio->next_offset += program->length;
+  if (pio->next_offset > 32) {
+    panic("PIO instruction memory is full");
+  }
+  return offset;
+}
+
+void pio_sm_set_enabled(PIO pio, uint sm, bool enabled) {}
+
+void pio_sm_clear_fifos(PIO pio, uint sm) { pio->sms.at(sm).rx.clear(); }
+
+void pio_sm_put(PIO pio, uint sm, std::uint32_t data) {
+  if (PioObserver()) {
+    PioObserver()(pio, sm, data);
+  }
+}
+
+bool pio_sm_is_tx_fifo_full(PIO pio, uint sm) { return false; }
+
+std::uint32_t pio_sm_get(PIO pio, uint sm) {
+  auto& rx = pio->sms.at(sm).rx;
+  if (rx.empty()) {
+    return 0;
+  }
+  const std::uint32_t value = rx.front();
+  rx.pop_front();
+  return value;
+}
+
+std::uint32_t pio_sm_get_blocking(PIO pio, uint sm) {
+  if (!pio->sms.at(sm).rx.empty()) {
+    return pio_sm_get(pio, sm);
+  }
+  for (const QuadratureDecoder& decoder : QuadratureDecoders()) {
+    if (decoder.pio == pio && decoder.sm == sm) {
+      return decoder.count;
+    }
+  }
+  panic("pio_sm_get_blocking would block forever");
+  return 0;
+}
+
+void pio_sim_run_quadrature_encoder(PIO pio, uint sm, uint pin_a, uint pin_b) {
+  QuadratureDecoder decoder = {.pio = pio, .sm = sm, .pins = {pin_a, pin_b}};
+  decoder.state = decoder.ReadPins();
+  QuadratureDecoders().push_back(decoder);
+}
+
+bool pio_sm_is_rx_fifo_empty(PIO pio, uint sm) {
+  return pio->sms.at(sm).rx.empty();
+}
+
+uint pio_sm_get_rx_fifo_level(PIO pio, uint sm) {
+  return static_cast<uint>(pio->sms.at(sm).rx.size());
+}
+
+void sim::PioPushRx(PIO pio, unsigned sm, std::uint32_t value) {
+  auto& rx = pio->sms.at(sm).rx;
+  // RX FIFO depth without joining.
+  if (rx.size() < 4) {
+    rx.push_back(value);
+  }
+}
+
+// hardware/uart.h
+
+struct uart_inst {
+  uint index;
+  uint baudrate = 0;
+  bool rx_irq_enabled = false;
+  bool tx_irq_enabled = false;
+  std::deque<std::uint8_t> rx;
+  // Bytes queued in the TX FIFO, and when the last of them will have been
+  // shifted out.
+  std::size_t tx_level = 0;
+  std::uint64_t tx_done_time = 0;
+};
+
+namespace {
+uart_inst uart_instances[2] = {{.index = 0}, {.index = 1}};
+
+constexpr std::size_t kUartFifoSize = 32;
+
+// Time to shift one byte with one start and one stop bit, rounded up.
+std::uint64_t UartByteTimeUs(const uart_inst_t* uart) {
+  if (uart->baudrate == 0) {
+    return 0;
+  }
+  return (10 * 1'000'000 + uart->baudrate - 1) / uart->baudrate;
+}
+
+void RaiseUartIrq(const uart_inst_t* uart) {
+  sim::RaiseIrq(UART0_IRQ + uart->index);
+}
+}  // namespace
+
+uart_inst_t* const uart0 = &uart_instances[0];
+uart_inst_t* const uart1 = &uart_instances[1];
+
+uart_inst_t* uart_get_instance(uint num) { return &uart_instances[num]; }
+
+uint uart_get_index(uart_inst_t* uart) { return uart->index; }
+
+uint uart_init(uart_inst_t* uart, uint baudrate) {
+  uart->baudrate = baudrate;
+  uart->rx.clear();
+  return baudrate;
+}
+
+void uart_deinit(uart_inst_t* uart) { *uart = {.index = uart->index}; }
+
+void uart_set_format(uart_inst_t* uart, uint data_bits, uint stop_bits,
+                     uart_parity_t parity) {}
+
+void uart_set_fifo_enabled(uart_inst_t* uart, bool enabled) {}
+
+void uart_set_irq_enables(uart_inst_t* uart, bool rx_has_data,
+                          bool tx_needs_data) {
+  uart->rx_irq_enabled = rx_has_data;
+  const bool tx_enabling = tx_needs_data && !uart->tx_irq_enabled;
+  uart->tx_irq_enabled = tx_needs_data;
+  // The TX interrupt is level-sensitive.
+  if (tx_enabling && uart->tx_level <= kUartFifoSize / 2) {
+    RaiseUartIrq(uart);
+  }
+}
+
+bool uart_is_readable(uart_inst_t* uart) { return !uart->rx.empty(); }
+
+char uart_getc(uart_inst_t* uart) {
+  if (uart->rx.empty()) {
+    panic("uart_getc would block forever");
+  }
+  const char c = uart->rx.front();
+  uart->rx.pop_front();
+  return c;
+}
+
+bool uart_is_writable(uart_inst_t* uart) {
+  return uart->tx_level < kUartFifoSize;
+}
+
+void uart_putc_raw(uart_inst_t* uart, char c) {
+  if (!uart_is_writable(uart)) {
+    // Overruns are dropped.
+    return;
+  }
+  ++uart->tx_level;
+  uart->tx_done_time =
+      std::max(uart->tx_done_time, sim::Now()) + UartByteTimeUs(uart);
+  sim::Schedule(uart->tx_done_time, [uart, byte = std::uint8_t(c)] {
+    --uart->tx_level;
+    if (UartObserver()) {
+      UartObserver()(uart, {&byte, 1});
+    }
+    if (uart->tx_irq_enabled && uart->tx_level == kUartFifoSize / 2) {
+      RaiseUartIrq(uart);
+    }
+  });
+}
+
+void uart_write_blocking(uart_inst_t* uart, const std::uint8_t* src,
+                         std::size_t len) {
+  for (std::size_t i = 0; i < len; ++i) {
+    while (!uart_is_writable(uart)) {
+      sim::AdvanceTo(*NextEventTime());
+    }
+    uart_putc_raw(uart, src[i]);
+  }
+}
+
+void sim::UartReceive(uart_inst_t* uart, std::span<const std::uint8_t> data) {
+  const std::uint64_t byte_time = UartByteTimeUs(uart);
+  for (std::size_t i = 0; i < data.size(); ++i) {
+    const std::uint8_t byte = data[i];
+    Schedule(Now() + (i + 1) * byte_time, [uart, byte] {
+      // Overruns are dropped, as by the hardware.
+      if (uart->rx.size() < kUartFifoSize) {
+        uart->rx.push_back(byte);
+      }
+      if (uart->rx_irq_enabled) {
+        RaiseUartIrq(uart);
+      }
+    });
+  }
+}
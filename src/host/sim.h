@@ -0,0 +1,61 @@
+#pragma once
+
+#include <hardware/pio.h>
+#include <hardware/spi.h>
+#include <hardware/uart.h>
+#include <pico/async_context.h>
+
+#include <cstdint>
+#include <functional>
+#include <span>
+
+// Controls and observes the simulated SDK used by the host build.
+//
+// The simulation is single-threaded and runs in virtual time: time only moves
+// forward when firmware sleeps or waits for work, or when the driver advances
+// it explicitly. Scheduled events and alarm callbacks run in time order as if
+// from an interrupt.
+namespace sim {
+
+// Simulated time in microseconds since boot.
+std::uint64_t Now();
+
+// Advances simulated time to `time`, running everything scheduled up to then.
+void AdvanceTo(std::uint64_t time);
+
+// Runs `event` at simulated time `time` (immediately if in the past).
+void Schedule(std::uint64_t time, std::function<void()> event);
+
+// Like async_context_wait_for_work_until(), but returns as soon as any of
+// `contexts` has work. Models one polling loop per core on the simulation's
+// single thread.
+void WaitForWorkUntil(std::span<async_context_t* const> contexts,
+                      std::uint64_t until);
+
+// Drives an input pin from outside the chip, e.g. an encoder contact. Edges
+// raise IO_IRQ_BANK0 if enabled for the pin.
+void DriveInput(unsigned pin, bool level);
+
+// Current level of a pin, whether driven by the firmware or externally.
+bool PinLevel(unsigned pin);
+
+// Calls the handlers for an interrupt if it is enabled.
+void RaiseIrq(unsigned num);
+
+// Pushes a word into a state machine's RX FIFO.
+void PioPushRx(PIO pio, unsigned sm, std::uint32_t value);
+
+// Delivers bytes to a UART's RX FIFO from outside the chip, starting now and
+// spaced at the UART's baud rate. Each byte raises the UART's interrupt if RX
+// interrupts are enabled.
+void UartReceive(uart_inst_t* uart, std::span<const std::uint8_t> data);
+
+// Observers for data leaving the firmware. Each replaces any previous
+// observer of the same kind.
+void OnPioPut(std::function<void(PIO pio, unsigned sm, std::uint32_t value)>);
+void OnSpiWrite(
+    std::function<void(spi_inst_t* spi, std::span<const std::uint8_t> data)>);
+void OnUartWrite(
+    std::function<void(uart_inst_t* uart, std::span<const std::uint8_t> data)>);
+
+}  // namespace sim
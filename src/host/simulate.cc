@@ -0,0 +1,181 @@
+// Runs the power feed controller against the simulated SDK. Spins the coarse
+// encoder with synthetic quadrature edges, one detent at a time, and reports
+// how long each detent takes to reach the step generator, the display and a
+// settled motor speed in simulated time, along with the host CPU time spent
+// handling it.
+
+#include <hardware/irq.h>
+#include <pico/async_context_poll.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "controller.h"
+#include "host/sim.h"
+#include "probe.h"
+
+namespace {
+
+// Pins of the coarse encoder; see Controller.
+constexpr unsigned kPinA = 17;
+constexpr unsigned kPinB = 16;
+
+// Runs both cores' async_contexts until simulated time reaches `until`.
+void RunUntil(std::span<async_context_t* const> contexts, std::uint64_t until) {
+  while (true) {
+    for (async_context_t* context : contexts) {
+      async_context_poll(context);
+    }
+    if (sim::Now() >= until) {
+      return;
+    }
+    sim::WaitForWorkUntil(contexts, until);
+  }
+}
+
+// Schedules the four quadrature edges of one detent starting at `start`,
+// `spacing_us` apart. Returns the time of the last edge, which completes the
+// detent.
+std::uint64_t ScheduleDetent(std::uint64_t start, int direction,
+                             std::uint64_t spacing_us) {
+  // Both contacts open (high) at rest. Turning forward closes B first.
+  struct Edge {
+    unsigned pin;
+    bool level;
+  };
+  std::vector<Edge> edges = {
+      {kPinB, false}, {kPinA, false}, {kPinB, true}, {kPinA, true}};
+  if (direction < 0) {
+    std::swap(edges[0].pin, edges[1].pin);
+    std::swap(edges[2].pin, edges[3].pin);
+  }
+  std::uint64_t time = start;
+  for (const Edge& edge : edges) {
+    sim::Schedule(time, [edge] { sim::DriveInput(edge.pin, edge.level); });
+    time += spacing_us;
+  }
+  return time - spacing_us;
+}
+
+struct Stats {
+  std::vector<std::uint64_t> samples;
+
+  void Add(std::uint64_t sample) { samples.push_back(sample); }
+
+  void Print(const char* name) {
+    if (samples.empty()) {
+      std::cout << name << ": no samples" << std::endl;
+      return;
+    }
+    std::sort(samples.begin(), samples.end());
+    std::uint64_t total = 0;
+    for (auto sample : samples) {
+      total += sample;
+    }
+    std::cout << name << ": mean " << total / samples.size() << "us, median "
+              << samples[samples.size() / 2] << "us, max " << samples.back()
+              << "us" << std::endl;
+  }
+};
+
+}  // namespace
+
+int main() {
+  irq_set_enabled(IO_IRQ_BANK0, true);
+
+  // Static so that it outlives the drivers' static interrupt state, which
+  // unregisters from it on exit.
+  static async_context_poll_t poll_context;
+  static async_context_poll_t motion_poll_context;
+  async_context_poll_init_with_defaults(&poll_context);
+  async_context_poll_init_with_defaults(&motion_poll_context);
+  const std::array<async_context_t*, 2> contexts = {&poll_context.core,
+                                                    &motion_poll_context.core};
+
+  Controller controller(poll_context.core, motion_poll_context.core);
+
+  std::optional<std::uint64_t> motor_time;
+  std::optional<std::uint64_t> display_time;
+  sim::OnPioPut([&](PIO, unsigned, std::uint32_t) {
+    if (!motor_time) {
+      motor_time = sim::Now();
+    }
+  });
+  sim::OnSpiWrite([&](spi_inst_t*, std::span<const std::uint8_t>) {
+    if (!display_time) {
+      display_time = sim::Now();
+    }
+  });
+
+  // Let startup activity settle.
+  RunUntil(contexts, sim::Now() + 100'000);
+
+  // Hold the right direction button so that the motor runs.
+  sim::DriveInput(14, false);
+  RunUntil(contexts, sim::Now() + 500'000);
+
+  const int detents = 32;
+  const std::uint64_t detent_period_us = 20'000;
+  const std::uint64_t edge_spacing_us = 500;
+  Stats motor_latency;
+  Stats display_latency;
+  Stats settle_time;
+  std::chrono::steady_clock::duration cpu_time{};
+  const std::int64_t initial_level = controller.level;
+  std::int64_t peak_level = initial_level;
+
+  for (int i = 0; i < detents; ++i) {
+    const int direction = i < detents / 2 ? 1 : -1;
+    const std::uint64_t start = sim::Now();
+    const std::uint64_t detent_time =
+        ScheduleDetent(start, direction, edge_spacing_us);
+
+    const auto cpu_start = std::chrono::steady_clock::now();
+    RunUntil(contexts, detent_time);
+    motor_time.reset();
+    display_time.reset();
+    std::optional<std::uint64_t> settled;
+    while (sim::Now() < start + detent_period_us) {
+      RunUntil(contexts, sim::Now() + 100);
+      // The ramp only starts moving once the detent reaches the motor.
+      if (!settled && motor_time && controller.ramp.Done()) {
+        settled = sim::Now();
+      }
+    }
+    cpu_time += std::chrono::steady_clock::now() - cpu_start;
+    peak_level = std::max(peak_level, controller.level);
+
+    if (motor_time) {
+      motor_latency.Add(*motor_time - detent_time);
+    }
+    if (display_time) {
+      display_latency.Add(*display_time - detent_time);
+    }
+    if (settled) {
+      settle_time.Add(*settled - detent_time);
+    }
+  }
+
+  std::cout << std::endl
+            << "Simulated " << detents << " coarse detents:" << std::endl;
+  motor_latency.Print("detent to step rate update");
+  display_latency.Print("detent to display transfer");
+  settle_time.Print("detent to settled step rate");
+  std::cout << "speed range covered: "
+            << double(peak_level - initial_level) /
+                   Controller::fine_steps_per_octave
+            << " octaves" << std::endl;
+  std::cout << "host CPU per detent: "
+            << std::chrono::duration_cast<std::chrono::microseconds>(cpu_time)
+                       .count() /
+                   detents
+            << "us" << std::endl;
+  probe::Print(std::cout);
+  return 0;
+}
@@ -0,0 +1,100 @@
+// Measures the TimerQueue's cost per timer to add, cancel and expire, with
+// thousands pending at once. Times are host wall-clock time, and expiry
+// includes polling the simulated async_context, so they show how the queue
+// scales rather than what it costs on the RP2040.
+
+#include <pico/async_context_poll.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "host/sim.h"
+#include "picoro/scheduler.h"
+#include "picoro/timer_queue.h"
+
+namespace {
+
+int expired = 0;
+
+void CountExpiry(Scheduler::Entry&) { ++expired; }
+
+struct Result {
+  double add_ns;
+  double cancel_ns;
+  double expire_ns;
+};
+
+// Adds `count` timers spread over the next `count` milliseconds, cancels every
+// other one, and runs the context until the rest expire.
+Result Run(async_context_t& context, TimerQueue& queue, int count) {
+  std::vector<Scheduler::Entry> entries(count, {.run = &CountExpiry});
+  std::vector<TimerQueue::Timer> timers(count);
+  std::mt19937 random(count);
+  const std::uint64_t start_us = sim::Now();
+  std::uniform_int_distribution<std::uint64_t> delay_us(1, 1'000 * count);
+  for (int i = 0; i < count; ++i) {
+    timers[i] = {.time = from_us_since_boot(start_us + delay_us(random)),
+                 .entry = &entries[i]};
+  }
+  using Clock = std::chrono::steady_clock;
+  const auto ns_per_timer = [](Clock::duration elapsed, int timers) {
+    return std::chrono::duration<double, std::nano>(elapsed).count() / timers;
+  };
+
+  Result result;
+  auto start = Clock::now();
+  for (auto& timer : timers) {
+    queue.Add(timer);
+  }
+  result.add_ns = ns_per_timer(Clock::now() - start, count);
+
+  start = Clock::now();
+  for (int i = 0; i < count; i += 2) {
+    queue.Cancel(timers[i]);
+  }
+  const int cancelled = (count + 1) / 2;
+  result.cancel_ns = ns_per_timer(Clock::now() - start, cancelled);
+
+  expired = 0;
+  start = Clock::now();
+  while (queue.Size() > 0 || expired < count - cancelled) {
+    async_context_wait_for_work_until(&context, at_the_end_of_time);
+    async_context_poll(&context);
+  }
+  result.expire_ns = ns_per_timer(Clock::now() - start, count - cancelled);
+  if (expired != count - cancelled) {
+    std::cerr << "Expected " << count - cancelled << " expiries, got "
+              << expired << std::endl;
+    std::exit(1);
+  }
+  return result;
+}
+
+}  // namespace
+
+int main() {
+  // Static so that it outlives the timer queue, which unregisters from it on
+  // exit.
+  static async_context_poll_t poll_context;
+  async_context_poll_init_with_defaults(&poll_context);
+  async_context_t& context = poll_context.core;
+  TimerQueue& queue = TimerQueue::ForContext(context);
+
+  std::cout << "Host ns per timer:" << std::endl;
+  std::cout << std::setw(8) << "timers" << std::setw(10) << "add"
+            << std::setw(10) << "cancel" << std::setw(10) << "expire"
+            << std::endl;
+  for (int count : {16, 256, 4096}) {
+    const Result result = Run(context, queue, count);
+    std::cout << std::fixed << std::setprecision(0) << std::setw(8) << count
+              << std::setw(10) << result.add_ns << std::setw(10)
+              << result.cancel_ns << std::setw(10) << result.expire_ns
+              << std::endl;
+  }
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include "modbus.h"
+
+#include <hardware/gpio.h>
+#include <hardware/irq.h>
+
+#include <utility>
+
+#include "crc16.h"
+
+namespace {
+// Size of an exception response: address, function | 0x80, exception code and
+// checksum.
+constexpr std::size_t kExceptionSize = 5;
+
+constexpr std::uint8_t kExceptionFlag = 0x80;
+
+constexpr std::size_t kChecksumSize = 2;
+
+// 8N1 framing.
+constexpr std::uint64_t kBitsPerByte = 10;
+}  // namespace
+
+void Modbus::State::Init(Pins pins, irq_handler_t rx_interrupt_handler) {
+  uart_init(uart, config.baudrate);
+  gpio_set_function(pins.tx, GPIO_FUNC_UART);
+  gpio_set_function(pins.rx, GPIO_FUNC_UART);
+  uart_set_format(uart, 8, 1, UART_PARITY_NONE);
+  // The RX interrupt fires on the FIFO threshold or once the line has been
+  // idle for a few characters, which conveniently coincides with the end of a
+  // frame.
+  uart_set_fifo_enabled(uart, true);
+
+  const unsigned irq = UART0_IRQ + uart_get_index(uart);
+  irq_set_exclusive_handler(irq, rx_interrupt_handler);
+  irq_set_enabled(irq, true);
+  const bool rx_interrupt = true;
+  const bool tx_interrupt = false;
+  uart_set_irq_enables(uart, rx_interrupt, tx_interrupt);
+}
+
+void Modbus::State::Start(std::span<const std::uint8_t> request,
+                          std::size_t response_size,
+                          std::coroutine_handle<> handle) {
+  const std::uint64_t transfer_us = (request.size() + response_size) *
+                                    kBitsPerByte * 1'000'000 / config.baudrate;
+  const absolute_time_t deadline =
+      make_timeout_time_us(transfer_us + config.timeout_us);
+  {
+    CriticalSectionLock lock(mutex);
+    if (pending) {
+      panic("Modbus request already in flight");
+    }
+    // Anything received between transactions is noise.
+    while (uart_is_readable(uart)) {
+      uart_getc(uart);
+    }
+    this->request = request;
+    this->response_size = 0;
+    expected_size = response_size;
+    timed_out = false;
+    pending = handle;
+    Transmit();
+  }
+
+  const bool fire_if_past = true;
+  const alarm_id_t alarm =
+      add_alarm_at(deadline, &TimeoutCallback, this, fire_if_past);
+  CriticalSectionLock lock(mutex);
+  if (pending) {
+    timeout_alarm = alarm;
+  } else {
+    // The response already arrived.
+    cancel_alarm(alarm);
+  }
+}
+
+void Modbus::State::Transmit() {
+  while (!request.empty() && uart_is_writable(uart)) {
+    uart_putc_raw(uart, request.front());
+    request = request.subspan(1);
+  }
+  const bool rx_interrupt = true;
+  const bool tx_interrupt = !request.empty();
+  uart_set_irq_enables(uart, rx_interrupt, tx_interrupt);
+}
+
+void Modbus::State::Finish() {
+  if (!pending) {
+    return;
+  }
+  if (timeout_alarm > 0) {
+    cancel_alarm(std::exchange(timeout_alarm, 0));
+  }
+  // Abandon any unsent remainder after a timeout.
+  request = {};
+  Transmit();
+  executor->Schedule(std::exchange(pending, nullptr));
+}
+
+void Modbus::State::HandleInterrupt() {
+  CriticalSectionLock lock(mutex);
+  Transmit();
+  while (uart_is_readable(uart)) {
+    const std::uint8_t byte = uart_getc(uart);
+    if (pending && response_size < response.size()) {
+      response[response_size++] = byte;
+    }
+  }
+  const bool is_exception =
+      response_size >= kExceptionSize && (response[1] & kExceptionFlag);
+  if (response_size >= expected_size || is_exception) {
+    Finish();
+  }
+}
+
+std::int64_t Modbus::State::TimeoutCallback(alarm_id_t id, void* user_data) {
+  State& state = *static_cast<State*>(user_data);
+  CriticalSectionLock lock(state.mutex);
+  if (id == state.timeout_alarm) {
+    state.timeout_alarm = 0;
+    state.timed_out = true;
+    state.Finish();
+  }
+  // Do not reschedule alarm.
+  return 0;
+}
+
+Modbus::Transaction::Transaction(State& state, std::uint8_t function,
+                                 std::size_t response_size)
+    : state_(state), response_size_(response_size) {
+  Append(state_.config.device_address);
+  Append(function);
+}
+
+void Modbus::Transaction::Seal() {
+  const std::uint16_t crc = Crc16(Request());
+  // The checksum is the only little-endian field.
+  Append(crc & 0xFF);
+  Append(crc >> 8);
+}
+
+Modbus::Result<std::span<const std::uint8_t>> Modbus::Transaction::Response()
+    const {
+  const auto frame = std::span(state_.response).first(state_.response_size);
+  if (state_.timed_out && frame.size() < kExceptionSize) {
+    return std::unexpected(Error::kTimeout);
+  }
+  const auto payload = frame.first(frame.size() - kChecksumSize);
+  const std::uint16_t crc = Crc16(payload);
+  if (frame[frame.size() - 2] != (crc & 0xFF) ||
+      frame[frame.size() - 1] != (crc >> 8)) {
+    return std::unexpected(state_.timed_out ? Error::kTimeout
+                                            : Error::kChecksum);
+  }
+  if (payload[0] != request_[0] ||
+      (payload[1] & ~kExceptionFlag) != request_[1]) {
+    return std::unexpected(Error::kUnexpectedResponse);
+  }
+  if (payload[1] & kExceptionFlag) {
+    return std::unexpected(Error::kException);
+  }
+  if (frame.size() != response_size_) {
+    return std::unexpected(Error::kUnexpectedResponse);
+  }
+  return payload;
+}
@@ -0,0 +1,320 @@
+#pragma once
+
+#include <hardware/uart.h>
+#include <pico/async_context.h>
+#include <pico/platform.h>
+#include <pico/time.h>
+
+#include <algorithm>
+#include <array>
+#include <coroutine>
+#include <cstdint>
+#include <expected>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+#include "picopp/critical_section.h"
+#include "picopp/irq.h"
+#include "picoro/async.h"
+
+// Modbus RTU master on a UART, talking to the motor drive directly rather than
+// through the rs232/ bridge. Accepting the UART number as a template argument
+// allows us to instantiate a different global interrupt handler function per
+// UART, as with RotaryEncoder.
+//
+// Requests are fed to the UART from its interrupt and the response is collected
+// the same way; the awaiting coroutine resumes on `context` once a full frame
+// has arrived or the timeout expires. Only one request may be in flight at a
+// time.
+//
+// Trivially copyable and moveable. Copied/moved values will refer to the same
+// internal state.
+class Modbus {
+ public:
+  enum class Error {
+    // No complete response before the timeout.
+    kTimeout,
+    kChecksum,
+    // The drive responded with a Modbus exception.
+    kException,
+    // Well-formed response that doesn't match the request.
+    kUnexpectedResponse,
+  };
+
+  template <typename T>
+  using Result = std::expected<T, Error>;
+
+  struct Pins {
+    unsigned tx;
+    unsigned rx;
+  };
+
+  struct Config {
+    unsigned baudrate = 9600;
+    std::uint8_t device_address = 63;
+    // Allowance for the drive to start responding, on top of the time taken to
+    // shift out the request and the response.
+    std::uint32_t timeout_us = 100'000;
+  };
+
+  // Must only be called once per UART. Not thread-safe.
+  template <unsigned uart_num>
+  static Modbus Create(async_context_t& context, Pins pins, Config config);
+
+  template <unsigned uart_num>
+  static Modbus Create(async_context_t& context, Pins pins) {
+    return Create<uart_num>(context, pins, Config{});
+  }
+
+  // Awaitable reading a single holding register (function 3). Resumes with
+  // Result<std::uint16_t>.
+  auto Read(std::uint16_t address);
+
+  // Awaitable writing a single holding register (function 6). Resumes with
+  // Result<void>.
+  auto Write(std::uint16_t address, std::uint16_t value);
+
+  // Most registers that fit into a single request or response.
+  static constexpr std::size_t kMaxReadRange = 125;
+  static constexpr std::size_t kMaxWriteRange = 123;
+
+  // Awaitable reading consecutive holding registers starting at `address` into
+  // `values` (function 3), which must outlive the transaction. Resumes with
+  // Result<void>.
+  auto ReadRange(std::uint16_t address, std::span<std::uint16_t> values);
+
+  // Awaitable writing `values` to consecutive holding registers starting at
+  // `address` (function 16). Resumes with Result<void>.
+  auto WriteRange(std::uint16_t address,
+                  std::span<const std::uint16_t> values);
+
+ private:
+  class Transaction;
+  struct State;
+
+  Modbus(State* state) : state_(state) {}
+  State* state_;
+};
+
+// Internal implementation details below.
+
+// Global state per UART.
+struct Modbus::State {
+  // Longest RTU frame permitted by the protocol.
+  static constexpr std::size_t kMaxFrameSize = 256;
+
+  uart_inst_t* uart;
+  Config config;
+
+  // Only nullopt to allow for default construction. This is populated before
+  // Init().
+  std::optional<AsyncExecutor> executor;
+
+  CriticalSection mutex;
+  // Remainder of the request yet to be queued into the TX FIFO.
+  std::span<const std::uint8_t> request;
+  std::array<std::uint8_t, kMaxFrameSize> response;
+  std::size_t response_size = 0;
+  // Size of the expected (non-exception) response.
+  std::size_t expected_size = 0;
+  bool timed_out = false;
+  alarm_id_t timeout_alarm = 0;
+  // Coroutine waiting for the response.
+  std::coroutine_handle<> pending;
+
+  // Setup the UART and register the given interrupt handler for it.
+  void Init(Pins pins, irq_handler_t rx_interrupt_handler);
+
+  // Sends `request` and arranges for `handle` to be resumed on the response or
+  // timeout. `request` must remain valid until then.
+  void Start(std::span<const std::uint8_t> request, std::size_t response_size,
+             std::coroutine_handle<> handle);
+
+  // Queues as much of the request as fits into the TX FIFO, and leaves the TX
+  // interrupt enabled only while more remains. Must be called with `mutex`
+  // held.
+  void Transmit();
+
+  // Resumes the pending coroutine, if any. Must be called with `mutex` held.
+  void Finish();
+
+  // Refills the TX FIFO and drains the RX FIFO.
+  void HandleInterrupt();
+
+  static std::int64_t TimeoutCallback(alarm_id_t id, void* user_data);
+};
+
+// Awaitable request/response exchange. Subclasses build the request and decode
+// the response.
+class Modbus::Transaction {
+ public:
+  bool await_ready() { return false; }
+
+  void await_suspend(std::coroutine_handle<> handle) {
+    state_.Start(std::span(request_).first(request_size_), response_size_,
+                 handle);
+  }
+
+ protected:
+  Transaction(State& state, std::uint8_t function, std::size_t response_size);
+
+  void Append(std::uint8_t byte) { request_[request_size_++] = byte; }
+  void Append16(std::uint16_t value) {
+    Append(value >> 8);
+    Append(value & 0xFF);
+  }
+  // Appends the checksum. Must be called last.
+  void Seal();
+
+  // The validated response without its checksum.
+  Result<std::span<const std::uint8_t>> Response() const;
+
+  std::span<const std::uint8_t> Request() const {
+    return std::span(request_).first(request_size_);
+  }
+
+  static std::uint16_t Read16(std::span<const std::uint8_t> data,
+                              std::size_t offset) {
+    return (data[offset] << 8) | data[offset + 1];
+  }
+
+ private:
+  State& state_;
+  std::array<std::uint8_t, State::kMaxFrameSize> request_;
+  std::size_t request_size_ = 0;
+  std::size_t response_size_;
+};
+
+template <unsigned uart_num>
+Modbus Modbus::Create(async_context_t& context, Pins pins, Config config) {
+  // Unique tag type for each UART.
+  using Tag = std::integral_constant<unsigned, uart_num>;
+  using Singleton = InterruptHandlerSingleton<Tag, State>;
+
+  State& state = Singleton::state;
+  state.uart = uart_get_instance(uart_num);
+  state.config = config;
+  state.executor.emplace(context);
+  state.Init(pins, Singleton::interrupt_handler);
+
+  return Modbus(&state);
+}
+
+inline auto Modbus::Read(std::uint16_t address) {
+  struct Awaiter : Transaction {
+    Awaiter(State& state, std::uint16_t address)
+        : Transaction(state, 3, /*response_size=*/7) {
+      Append16(address);
+      // Register count.
+      Append16(1);
+      Seal();
+    }
+
+    Result<std::uint16_t> await_resume() {
+      const auto response = Response();
+      if (!response) {
+        return std::unexpected(response.error());
+      }
+      // Byte count.
+      if ((*response)[2] != 2) {
+        return std::unexpected(Error::kUnexpectedResponse);
+      }
+      return Read16(*response, 3);
+    }
+  };
+  return Awaiter(*state_, address);
+}
+
+inline auto Modbus::Write(std::uint16_t address, std::uint16_t value) {
+  struct Awaiter : Transaction {
+    Awaiter(State& state, std::uint16_t address, std::uint16_t value)
+        : Transaction(state, 6, /*response_size=*/8) {
+      Append16(address);
+      Append16(value);
+      Seal();
+    }
+
+    Result<void> await_resume() {
+      const auto response = Response();
+      if (!response) {
+        return std::unexpected(response.error());
+      }
+      // The drive echoes the request.
+      if (!std::ranges::equal(*response, Request().first(6))) {
+        return std::unexpected(Error::kUnexpectedResponse);
+      }
+      return {};
+    }
+  };
+  return Awaiter(*state_, address, value);
+}
+
+inline auto Modbus::ReadRange(std::uint16_t address,
+                              std::span<std::uint16_t> values) {
+  struct Awaiter : Transaction {
+    std::span<std::uint16_t> values;
+
+    Awaiter(State& state, std::uint16_t address,
+            std::span<std::uint16_t> values)
+        : Transaction(state, 3, /*response_size=*/5 + 2 * values.size()),
+          values(values) {
+      if (values.size() > kMaxReadRange) {
+        panic("Modbus read range too long");
+      }
+      Append16(address);
+      Append16(values.size());
+      Seal();
+    }
+
+    Result<void> await_resume() {
+      const auto response = Response();
+      if (!response) {
+        return std::unexpected(response.error());
+      }
+      // Byte count.
+      if ((*response)[2] != 2 * values.size()) {
+        return std::unexpected(Error::kUnexpectedResponse);
+      }
+      for (std::size_t i = 0; i < values.size(); ++i) {
+        values[i] = Read16(*response, 3 + 2 * i);
+      }
+      return {};
+    }
+  };
+  return Awaiter(*state_, address, values);
+}
+
+inline auto Modbus::WriteRange(std::uint16_t address,
+                               std::span<const std::uint16_t> values) {
+  struct Awaiter : Transaction {
+    Awaiter(State& state, std::uint16_t address,
+            std::span<const std::uint16_t> values)
+        : Transaction(state, 16, /*response_size=*/8) {
+      if (values.size() > kMaxWriteRange) {
+        panic("Modbus write range too long");
+      }
+      Append16(address);
+      Append16(values.size());
+      // Byte count.
+      Append(2 * values.size());
+      for (std::uint16_t value : values) {
+        Append16(value);
+      }
+      Seal();
+    }
+
+    Result<void> await_resume() {
+      const auto response = Response();
+      if (!response) {
+        return std::unexpected(response.error());
+      }
+      // The drive echoes the address and count.
+      if (!std::ranges::equal(*response, Request().first(6))) {
+        return std::unexpected(Error::kUnexpectedResponse);
+      }
+      return {};
+    }
+  };
+  return Awaiter(*state_, address, values);
+}
@@ -1,28 +1,77 @@
 #include "oled.h"
 
+#include <hardware/dma.h>
 #include <hardware/gpio.h>
+#include <hardware/irq.h>
 #include <pico/time.h>
 
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
 namespace {
 enum Command : std::uint8_t {
   kPowerOn = 0xAF,
   kDisplayOff = 0xA5,
   kDisplayOn = 0xA4,
   kSetAddressMode = 0x20,
+  kSetColumnAddress = 0x21,
+  kSetPageAddress = 0x22,
   kFlipHorizontally = 0xA1,
   kFlipVertically = 0xC8,
 };
+
+// Narrows `columns` to the smallest range within which `a` and `b` differ.
+// Whole words are compared first, then the ends are trimmed byte by byte.
+OledBuffer::Columns Difference(std::span<const std::uint8_t> a,
+                               std::span<const std::uint8_t> b,
+                               OledBuffer::Columns columns) {
+  using Word = std::uint32_t;
+  constexpr std::size_t kWordSize = sizeof(Word);
+  const auto word_at = [](std::span<const std::uint8_t> data, std::size_t i) {
+    Word word;
+    std::memcpy(&word, &data[i], kWordSize);
+    return word;
+  };
+  std::size_t begin = columns.begin;
+  std::size_t end = columns.end;
+  while (begin + kWordSize <= end && word_at(a, begin) == word_at(b, begin)) {
+    begin += kWordSize;
+  }
+  while (begin + kWordSize <= end &&
+         word_at(a, end - kWordSize) == word_at(b, end - kWordSize)) {
+    end -= kWordSize;
+  }
+  while (begin < end && a[begin] == b[begin]) {
+    ++begin;
+  }
+  while (begin < end && a[end - 1] == b[end - 1]) {
+    --end;
+  }
+  return {.begin = begin, .end = end};
+}
 }  // namespace
 
-Oled::Oled(spi_inst_t* spi, Pins pins)
+Oled::Oled(async_context_t& context, spi_inst_t* spi, Pins pins)
     : spi_(spi, 8'000'000),
       spi_clock_(pins.clock, {.function = GPIO_FUNC_SPI}),
       spi_data_(pins.data, {.function = GPIO_FUNC_SPI}),
       reset_(pins.reset, {.polarity = Gpio::kNegative}),
       chip_select_(pins.cs, {.polarity = Gpio::kNegative}),
       data_mode_(pins.dc),
+      transfer_(TransferInterrupt::state),
+      front_(width_ * height_ / 8),
       data_(width_ * height_ / 8),
       buffer_(data_.data(), width_, height_) {
+  dma_.ConfigureWrite(spi_.DataRegister(), spi_.TxDreq());
+  transfer_.dma_channel = dma_.get();
+  transfer_.worker =
+      AsyncWorker::Create(context, [this] { SendNextWindow(); });
+  irq_add_shared_handler(DMA_IRQ_0, TransferInterrupt::interrupt_handler,
+                         PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+  irq_set_enabled(DMA_IRQ_0, true);
+  dma_channel_set_irq0_enabled(dma_.get(), true);
+
   chip_select_.Set();
   Reset();
 }
@@ -44,14 +93,106 @@ void Oled::Reset() {
       kFlipVertically,
       kDisplayOn,
   }});
+  // Display RAM contents are undefined after reset.
+  buffer_.MarkAllDirty();
+  front_stale_ = true;
 }
 
 void Oled::SendCommands(std::span<const std::uint8_t> commands) {
+  WaitForTransfer();
   CommandMode();
   spi_.Write(commands);
 }
 
 void Oled::Update() {
+  WaitForTransfer();
+  CollectWindows();
+  for (std::size_t page = 0; page < windows_.size(); ++page) {
+    if (windows_[page].empty()) {
+      continue;
+    }
+    SetWindow(page);
+    DataMode();
+    spi_.Write(Window(page));
+  }
+}
+
+void Oled::CollectWindows() {
+  windows_.fill({.begin = 0, .end = 0});
+  const auto dirty = buffer_.Dirty();
+  for (std::size_t page = 0; page < dirty.size(); ++page) {
+    const auto back = buffer_.Page(page);
+    const auto front = std::span(front_).subspan(page * width_, width_);
+    OledBuffer::Columns window = dirty[page];
+    if (!front_stale_) {
+      window = Difference(back, front, window);
+    }
+    if (window.empty()) {
+      continue;
+    }
+    std::copy(back.begin() + window.begin, back.begin() + window.end,
+              front.begin() + window.begin);
+    windows_[page] = window;
+  }
+  buffer_.ClearDirty();
+  front_stale_ = false;
+  next_page_ = 0;
+}
+
+void Oled::SetWindow(std::size_t page) {
+  const OledBuffer::Columns& window = windows_[page];
+  SendCommands({{
+      kSetColumnAddress,
+      static_cast<std::uint8_t>(window.begin),
+      static_cast<std::uint8_t>(window.end - 1),
+      kSetPageAddress,
+      static_cast<std::uint8_t>(page),
+      static_cast<std::uint8_t>(page),
+  }});
+}
+
+std::span<const std::uint8_t> Oled::Window(std::size_t page) const {
+  const OledBuffer::Columns& window = windows_[page];
+  return std::span(front_).subspan(page * width_ + window.begin,
+                                   window.end - window.begin);
+}
+
+void Oled::StartUpdate() {
+  WaitForTransfer();
+  CollectWindows();
+  in_flight_ = true;
+  SendNextWindow();
+}
+
+void Oled::SendNextWindow() {
+  while (next_page_ < windows_.size() && windows_[next_page_].empty()) {
+    ++next_page_;
+  }
+  if (next_page_ == windows_.size()) {
+    in_flight_ = false;
+    if (transfer_.pending) {
+      std::exchange(transfer_.pending, nullptr).resume();
+    }
+    return;
+  }
+  const std::size_t page = next_page_++;
+  SetWindow(page);
   DataMode();
-  spi_.Write(buffer_.Span());
+  dma_.StartWrite(Window(page));
+}
+
+void Oled::WaitForTransfer() {
+  dma_.Wait();
+  // DMA completes once the last byte is in the TX FIFO; the FIFO still needs
+  // to drain before we can touch the D/C line.
+  while (spi_.Busy()) {
+  }
+}
+
+void Oled::TransferState::HandleInterrupt() {
+  if (!dma_channel_get_irq0_status(dma_channel)) {
+    return;
+  }
+  dma_channel_acknowledge_irq0(dma_channel);
+  worker.SetWorkPending();
 }
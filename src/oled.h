@@ -1,14 +1,22 @@
 #pragma once
 
+#include <pico/async_context.h>
+
+#include <array>
+#include <coroutine>
 #include <cstdint>
 #include <vector>
 
+#include "picopp/async.h"
+#include "picopp/dma.h"
 #include "picopp/gpio.h"
+#include "picopp/irq.h"
 #include "picopp/spi.h"
 
 #include "oled_buffer.h"
 
-// SSD1309 display driver.
+// SSD1309 display driver. Only one instance may exist at a time, as DMA
+// completion is signalled through a global interrupt handler.
 class Oled {
  public:
   struct Pins {
@@ -19,7 +27,8 @@ class Oled {
     unsigned cs;
   };
 
-  Oled(spi_inst_t* spi, Pins pins);
+  // Coroutines awaiting UpdateAsync() will resume execution on `context`.
+  Oled(async_context_t& context, spi_inst_t* spi, Pins pins);
 
   void Reset();
 
@@ -28,9 +37,39 @@ class Oled {
 
   OledBuffer& Buffer() { return buffer_; }
 
+  // Sends the changes drawn into Buffer() to the display, blocking until done.
+  // Must not be called while an UpdateAsync() frame is in flight.
   void Update();
 
+  // Awaitable equivalent of Update() that sends the frame via DMA. The
+  // awaiting coroutine only suspends while the previous frame is still in
+  // flight; once this frame has been captured it resumes immediately, and may
+  // draw the next frame while this one is being sent.
+  auto UpdateAsync();
  private:
+  struct TransferState;
+  // The display type doubles as the unique tag for the interrupt handler.
+  using TransferInterrupt = InterruptHandlerSingleton<Oled, TransferState>;
+
+  // Compares the back buffer's dirty ranges against the front buffer, copies
+  // the differences forward, and takes them as the windows to send.
+  void CollectWindows();
+
+  // Points the display's write address at the given page's window.
+  void SetWindow(std::size_t page);
+
+  std::span<const std::uint8_t> Window(std::size_t page) const;
+
+  // Captures the back buffer and starts sending it in the background.
+  void StartUpdate();
+
+  // Starts the DMA transfer for the next window, or finishes the frame and
+  // resumes the pending coroutine (if any) if all windows have been sent.
+  void SendNextWindow();
+
+  // Blocks until any in-flight DMA transfer has been fully shifted out.
+  void WaitForTransfer();
+
   void DataMode() { data_mode_.Set(); }
   void CommandMode() { data_mode_.Clear(); }
 
@@ -45,6 +84,51 @@ class Oled {
   Gpio data_mode_;
   Gpio chip_select_;
 
+  DmaChannel dma_;
+  TransferState& transfer_;
+
+  // Windows of the update in progress, indexed by page.
+  std::array<OledBuffer::Columns, OledBuffer::kMaxPages> windows_;
+  std::size_t next_page_ = 0;
+  bool in_flight_ = false;
+
+  // Contents of the display once the frame in flight completes. Transfers are
+  // only ever made from this buffer.
+  std::vector<std::uint8_t> front_;
+  // Set when the display contents are unknown and the diff can't be trusted.
+  bool front_stale_ = true;
+
+  // Back buffer, drawn into via `buffer_`.
   std::vector<std::uint8_t> data_;
   OledBuffer buffer_;
 };
+
+// Internal implementation details below.
+
+// Global state shared with the DMA completion interrupt handler.
+struct Oled::TransferState {
+  unsigned dma_channel;
+  // Runs SendNextWindow() on the async_context.
+  AsyncWorker worker;
+  // Coroutine waiting for the frame in flight to complete.
+  std::coroutine_handle<> pending;
+
+  void HandleInterrupt();
+};
+
+inline auto Oled::UpdateAsync() {
+  struct Awaiter {
+    Oled& oled;
+
+    bool await_ready() { return !oled.in_flight_; }
+
+    // The in-flight frame is advanced by a worker on the same async_context,
+    // so it can't complete between await_ready() and await_suspend().
+    void await_suspend(std::coroutine_handle<> handle) {
+      oled.transfer_.pending = handle;
+    }
+
+    void await_resume() { oled.StartUpdate(); }
+  };
+  return Awaiter{.oled = *this};
+}
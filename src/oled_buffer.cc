@@ -1,19 +1,45 @@
 #include "oled_buffer.h"
 
+#include <pico/platform.h>
+
+#include <algorithm>
+
 OledBuffer::OledBuffer(std::uint8_t* data, std::size_t width,
                        std::size_t height)
-    : data_(data), width_(width), height_(height) {}
+    : data_(data), width_(width), height_(height) {
+  MarkAllDirty();
+}
 
 auto OledBuffer::operator()(std::size_t x, std::size_t y) -> Pixel {
   const std::size_t block_col = x;
   const std::size_t block_row = y >> 3;
   const std::size_t offset = y & 0b111;
-  return Pixel(data_[block_col + block_row * width_], offset);
+  return Pixel(*this, block_col, block_row, offset);
 }
 
 void OledBuffer::Clear() {
-  for (auto& value : Span()) {
-    value = 0;
+  for (std::size_t page = 0; page < Pages(); ++page) {
+    for (std::size_t x = 0; x < width_; ++x) {
+      Write(x, page, 0);
+    }
+  }
+}
+
+void OledBuffer::ClearRect(std::size_t x0, std::size_t y0, std::size_t x1,
+                           std::size_t y1) {
+  x1 = std::min(x1, width_);
+  y1 = std::min(y1, height_);
+  if (x0 >= x1 || y0 >= y1) {
+    return;
+  }
+  for (std::size_t page = y0 / 8; page <= (y1 - 1) / 8; ++page) {
+    // Bits of this page's blocks that fall within [y0, y1).
+    const std::size_t top = std::max(y0, page * 8) - page * 8;
+    const std::size_t bottom = std::min(y1, page * 8 + 8) - page * 8;
+    const std::uint8_t mask = (0xFF << top) & (0xFF >> (8 - bottom));
+    for (std::size_t x = x0; x < x1; ++x) {
+      Write(x, page, Block(x, page) & ~mask);
+    }
   }
 }
 
@@ -25,20 +51,56 @@ std::span<std::uint8_t> OledBuffer::Span() {
   return {data_, width_ * height_ / 8};
 }
 
+void OledBuffer::MarkAllDirty() {
+  dirty_.fill({.begin = 0, .end = width_});
+}
+
+void OledBuffer::ClearDirty() { dirty_.fill({.begin = width_, .end = 0}); }
+
+void OledBuffer::Write(std::size_t x, std::size_t page, std::uint8_t value) {
+  std::uint8_t& block = Block(x, page);
+  if (block == value) {
+    return;
+  }
+  block = value;
+  Columns& dirty = dirty_[page];
+  dirty.begin = std::min(dirty.begin, x);
+  dirty.end = std::max(dirty.end, x + 1);
+}
+
 void OledBuffer::DrawChar(const Font& font, char letter, std::size_t x0,
                           std::size_t y0) {
-  OledBuffer font_data(const_cast<std::uint8_t*>(font[letter]), font.width,
-                       font.height);
-
-  const auto x1 = std::min(width_, x0 + font.width);
-  const auto y1 = std::min(height_, y0 + font.height);
-
-  const std::size_t width = x1 - x0;
-  const std::size_t height = y1 - y0;
-  for (std::size_t dx = 0; dx < width; ++dx) {
-    for (std::size_t dy = 0; dy < height; ++dy) {
-      if (font_data(dx, dy)) {
-        (*this)(x0 + dx, y0 + dy) = 1;
+  if (x0 >= width_ || y0 >= height_ || !font.Contains(letter)) {
+    return;
+  }
+  // Glyphs use the same layout of vertical blocks as the image, so we copy a
+  // block at a time as they are decoded. When y0 isn't a multiple of 8, each
+  // glyph block straddles two pages of the image.
+  GlyphReader glyph = font.Glyph(letter);
+  const std::size_t width = std::min<std::size_t>(font.width, width_ - x0);
+  const std::size_t glyph_pages = (font.height + 7) / 8;
+  const std::size_t first_page = y0 >> 3;
+  const std::size_t shift = y0 & 0b111;
+  const std::size_t end_page = std::min(Pages(), first_page + glyph_pages + 1);
+  // Excludes the padding rows at the bottom of the glyph.
+  const std::uint8_t last_row_mask = 0xFF >> (glyph_pages * 8 - font.height);
+  for (std::size_t row = 0; row < glyph_pages; ++row) {
+    const std::size_t page = first_page + row;
+    if (page >= end_page) {
+      break;
+    }
+    const std::uint8_t mask = row + 1 == glyph_pages ? last_row_mask : 0xFF;
+    const bool has_lower_page = shift != 0 && page + 1 < end_page;
+    // Blocks past the right edge are still read, to reach the next row.
+    for (std::size_t dx = 0; dx < std::size_t(font.width); ++dx) {
+      const unsigned bits = unsigned(glyph.Next() & mask) << shift;
+      if (bits == 0 || dx >= width) {
+        continue;
+      }
+      const std::size_t x = x0 + dx;
+      Write(x, page, Block(x, page) | (bits & 0xFF));
+      if (has_lower_page) {
+        Write(x, page + 1, Block(x, page + 1) | (bits >> 8));
       }
     }
   }
@@ -52,22 +114,58 @@ void OledBuffer::DrawString(const Font& font, std::string_view text,
   }
 }
 
+std::size_t OledBuffer::DrawStringCentered(const Font& font,
+                                           std::string_view text,
+                                           std::size_t y0) {
+  const std::size_t x0 = CenterX(TextWidth(font, text));
+  DrawString(font, text, x0, y0);
+  return x0;
+}
+
 void OledBuffer::DrawLineH(std::size_t y, std::size_t x0, std::size_t x1) {
   for (std::size_t x = x0; x < x1; ++x) {
     (*this)(x, y) = true;
   }
 }
 
-OledBuffer::Pixel::Pixel(std::uint8_t& block, std::uint8_t offset)
-    : block_(block), offset_(offset) {}
+void OledBuffer::Blit(const OledBuffer& sprite, std::size_t x0,
+                      std::size_t page0) {
+  if (x0 >= width_) {
+    return;
+  }
+  const std::size_t width = std::min(sprite.Width(), width_ - x0);
+  const std::size_t end_page = std::min(Pages(), page0 + sprite.Pages());
+  for (std::size_t page = page0; page < end_page; ++page) {
+    const std::uint8_t* const blocks = sprite.Page(page - page0).data();
+    for (std::size_t dx = 0; dx < width; ++dx) {
+      Write(x0 + dx, page, blocks[dx]);
+    }
+  }
+}
 
-OledBuffer::Pixel::operator bool() const { return block_ & (1 << offset_); }
+OledBuffer SpriteCache::Create(std::size_t width, std::size_t height) {
+  if (height % 8 != 0) {
+    panic("Sprite height must be a multiple of 8");
+  }
+  const std::size_t size = width * height / 8;
+  if (size > storage_.size() - used_) {
+    panic("Sprite cache full");
+  }
+  std::uint8_t* const data = storage_.data() + used_;
+  used_ += size;
+  return OledBuffer(data, width, height);
+}
+
+OledBuffer::Pixel::Pixel(OledBuffer& buffer, std::size_t x, std::size_t page,
+                         std::uint8_t offset)
+    : buffer_(buffer), x_(x), page_(page), offset_(offset) {}
+
+OledBuffer::Pixel::operator bool() const {
+  return buffer_.Block(x_, page_) & (1 << offset_);
+}
 
 void OledBuffer::Pixel::operator=(bool value) {
   const std::uint8_t rhs = 1 << offset_;
-  if (value) {
-    block_ |= rhs;
-  } else {
-    block_ &= ~rhs;
-  }
+  const std::uint8_t block = buffer_.Block(x_, page_);
+  buffer_.Write(x_, page_, value ? (block | rhs) : (block & ~rhs));
 }
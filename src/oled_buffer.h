@@ -1,5 +1,6 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <span>
 #include <string_view>
@@ -10,30 +11,90 @@
 //
 // Data internally is stored as a row-major array of 8-bit vertically-oriented
 // blocks, with the LSB oriented towards the top (greatest y-value) row of the
-// image.
+// image. Each row of blocks is a "page".
+//
+// Modifications are tracked per page as a range of dirty columns, so that a
+// display driver can send only the parts of the image that changed. Writes that
+// leave a block unchanged do not mark it dirty.
+//
+// Images that are drawn repeatedly, like labels and arrows, can be rendered
+// once into sprites from a SpriteCache, which are small buffers in the same
+// layout. Blit() then copies them in whole blocks rather than decoding glyphs
+// again.
 class OledBuffer {
  public:
   class Pixel;
 
+  // Half-open range of columns [begin, end).
+  struct Columns {
+    std::size_t begin;
+    std::size_t end;
+
+    bool empty() const { return begin >= end; }
+  };
+
+  // Maximum supported height is kMaxPages * 8. The whole image starts dirty.
+  static constexpr std::size_t kMaxPages = 8;
+
   OledBuffer(uint8_t* data, std::size_t width, std::size_t height);
 
   Pixel operator()(std::size_t x, std::size_t y);
 
   std::size_t Width() const { return width_; }
   std::size_t Height() const { return height_; }
+  std::size_t Pages() const { return (height_ + 7) / 8; }
 
   void Clear();
 
+  // Clears all pixels within [x0, x1) x [y0, y1).
+  void ClearRect(std::size_t x0, std::size_t y0, std::size_t x1,
+                 std::size_t y1);
+
   std::span<const std::uint8_t> Span() const;
   std::span<std::uint8_t> Span();
 
+  // Blocks of a single page.
+  std::span<const std::uint8_t> Page(std::size_t page) const {
+    return Span().subspan(page * width_, width_);
+  }
+
+  // Dirty column range for each page.
+  std::span<const Columns> Dirty() const { return {dirty_.data(), Pages()}; }
+
+  void MarkAllDirty();
+  void ClearDirty();
+
   void DrawChar(const Font& font, char letter, std::size_t x0, std::size_t y0);
 
   void DrawString(const Font& font, std::string_view text, std::size_t x0,
                   std::size_t y0);
 
+  // Width of `text` in pixels. Fonts are monospaced.
+  static std::size_t TextWidth(const Font& font, std::string_view text) {
+    return text.size() * font.width;
+  }
+
+  // Left edge that centers something `width` pixels wide within [x0, x1), or
+  // x0 if it doesn't fit.
+  static std::size_t CenterX(std::size_t width, std::size_t x0,
+                             std::size_t x1) {
+    return width < x1 - x0 ? x0 + (x1 - x0 - width) / 2 : x0;
+  }
+  std::size_t CenterX(std::size_t width) const {
+    return CenterX(width, 0, width_);
+  }
+
+  // Draws `text` horizontally centered on the whole width. Returns its left
+  // edge.
+  std::size_t DrawStringCentered(const Font& font, std::string_view text,
+                                 std::size_t y0);
+
   void DrawLineH(std::size_t y, std::size_t x0, std::size_t x1);
 
+  // Replaces the blocks under `sprite` with its own, with its top-left corner
+  // at column `x0` of `page0`. Sprites are clipped at the edges.
+  void Blit(const OledBuffer& sprite, std::size_t x0, std::size_t page0);
+
   // Allows read/write access to individual bits of the image as if they were
   // boolean values.
   class Pixel {
@@ -43,14 +104,39 @@ class OledBuffer {
 
    private:
     friend class OledBuffer;
-    Pixel(std::uint8_t& block, std::uint8_t offset);
+    Pixel(OledBuffer& buffer, std::size_t x, std::size_t page,
+          std::uint8_t offset);
 
-    std::uint8_t& block_;
+    OledBuffer& buffer_;
+    std::size_t x_;
+    std::size_t page_;
     std::uint8_t offset_;
   };
 
  private:
+  std::uint8_t& Block(std::size_t x, std::size_t page) {
+    return data_[x + page * width_];
+  }
+
+  // Replaces a block, marking it dirty if its value changes.
+  void Write(std::size_t x, std::size_t page, std::uint8_t value);
+
   std::uint8_t* const data_;
   const std::size_t width_;
   const std::size_t height_;
+  std::array<Columns, kMaxPages> dirty_;
+};
+
+// Fixed storage for sprites, which are never freed.
+class SpriteCache {
+ public:
+  static constexpr std::size_t kBytes = 512;
+
+  // Reserves a blank `width` x `height` sprite and returns a buffer to draw
+  // it with. `height` must be a multiple of 8. Panics if the cache is full.
+  OledBuffer Create(std::size_t width, std::size_t height);
+
+ private:
+  std::array<std::uint8_t, kBytes> storage_ = {};
+  std::size_t used_ = 0;
 };
@@ -147,7 +147,7 @@ class AsyncScheduledWorker {
   template <typename Tag, typename F>
   struct Singleton;
 
-  State* state_;
+  State* state_ = nullptr;
 };
 
 struct AsyncScheduledWorker::State {
@@ -190,6 +190,13 @@ AsyncScheduledWorker AsyncScheduledWorker::Create(async_context_t& context,
   return worker;
 }
 
+inline AsyncScheduledWorker::~AsyncScheduledWorker() {
+  if (state_ == nullptr) {
+    return;
+  }
+  async_context_remove_at_time_worker(state_->context, &state_->worker);
+}
+
 inline void AsyncScheduledWorker::ScheduleAt(absolute_time_t time) {
   state_->ScheduleAt(time);
 }
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <hardware/dma.h>
+
+#include <cstdint>
+#include <span>
+
+// C++ wrapper around a claimed DMA channel.
+class DmaChannel {
+ public:
+  // Claims an unused channel; panics if none are available.
+  DmaChannel();
+  ~DmaChannel();
+
+  void operator=(const DmaChannel&) = delete;
+
+  unsigned get() const { return channel_; }
+
+  // Configures the channel for byte-wise copies from memory into the fixed
+  // peripheral register `destination`, paced by the peripheral's `dreq`.
+  void ConfigureWrite(volatile void* destination, unsigned dreq);
+
+  // Starts copying `source` to the configured destination. `source` must
+  // remain valid until the transfer completes.
+  void StartWrite(std::span<const std::uint8_t> source);
+
+  bool Busy() const { return dma_channel_is_busy(channel_); }
+
+  // Blocks until the current transfer (if any) has completed.
+  void Wait() { dma_channel_wait_for_finish_blocking(channel_); }
+
+ private:
+  unsigned channel_;
+};
+
+inline DmaChannel::DmaChannel() {
+  const bool required = true;
+  channel_ = dma_claim_unused_channel(required);
+}
+
+inline DmaChannel::~DmaChannel() { dma_channel_unclaim(channel_); }
+
+inline void DmaChannel::ConfigureWrite(volatile void* destination,
+                                       unsigned dreq) {
+  dma_channel_config config = dma_channel_get_default_config(channel_);
+  channel_config_set_transfer_data_size(&config, DMA_SIZE_8);
+  channel_config_set_dreq(&config, dreq);
+  channel_config_set_read_increment(&config, true);
+  channel_config_set_write_increment(&config, false);
+  const bool start = false;
+  dma_channel_configure(channel_, &config, destination, nullptr, 0, start);
+}
+
+inline void DmaChannel::StartWrite(std::span<const std::uint8_t> source) {
+  dma_channel_transfer_from_buffer_now(channel_, source.data(), source.size());
+}
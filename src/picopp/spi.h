@@ -23,6 +23,13 @@ class Spi {
 
   int Write(std::span<const std::uint8_t> payload);
 
+  // True while data is still being shifted out.
+  bool Busy() const { return spi_is_busy(spi_); }
+
+  // Data register and TX DREQ number, for feeding the SPI from DMA.
+  volatile void* DataRegister() const { return &spi_get_hw(spi_)->dr; }
+  unsigned TxDreq() const { return spi_get_dreq(spi_, true); }
+
  private:
   spi_inst_t* spi_ = nullptr;
 };
@@ -1,17 +1,24 @@
 #pragma once
 
 #include <pico/async_context.h>
+#include <pico/platform.h>
 #include <pico/time.h>
 
+#include <array>
 #include <coroutine>
+#include <cstddef>
 #include <cstdint>
 
+#include "picoro/scheduler.h"
+#include "picoro/timer_queue.h"
+
 // Allows resumption of a coroutine onto an async_context. Each executor
 // instance can manage at most one suspended coroutine.
 class AsyncExecutor {
  public:
   // Not thread-safe.
   AsyncExecutor(async_context_t& context);
+  // Cancels any pending resumption.
   ~AsyncExecutor();
 
   void operator=(const AsyncExecutor&) = delete;
@@ -25,7 +32,7 @@ class AsyncExecutor {
   auto Schedule();
 
   // Schedules a suspended coroutine for resumption on the async_context at the
-  // given time.
+  // given time. Must be called on the async_context.
   void ScheduleAt(absolute_time_t time, std::coroutine_handle<> handle);
 
   // An awaitable that suspends the current coroutine and resumes it on the
@@ -33,36 +40,27 @@ class AsyncExecutor {
   auto SleepUntil(absolute_time_t time);
 
  private:
-  struct WorkerState {
-    // Note: a standard-layout object is pointer-interconvertible with its first
-    // member.
-    async_when_pending_worker_t worker;
-    async_context_t& context;
-    std::coroutine_handle<> handle;
-  };
-
-  // async_context worker callback.
-  static void ResumeInContext(async_context_t* context,
-                              async_when_pending_worker_t* worker);
-
-  static std::int64_t AlarmCallback(alarm_id_t id, void* user_data);
-
-  WorkerState state_;
+  TimerQueue& timers_;
+  Scheduler::Resumer resumer_;
+  TimerQueue::Timer timer_ = {.entry = &resumer_};
 };
 
 inline AsyncExecutor::AsyncExecutor(async_context_t& context)
-    : state_({.worker = {.do_work = &ResumeInContext, .work_pending = false},
-              .context = context}) {
-  async_context_add_when_pending_worker(&state_.context, &state_.worker);
-}
+    : timers_(TimerQueue::ForContext(context)) {}
 
 inline AsyncExecutor::~AsyncExecutor() {
-  async_context_remove_when_pending_worker(&state_.context, &state_.worker);
+  // Checked first so that idle static executors don't touch the queues, which
+  // may already be gone at exit.
+  if (timer_.Pending()) {
+    timers_.Cancel(timer_);
+  }
+  if (resumer_.queued) {
+    timers_.scheduler().Cancel(resumer_);
+  }
 }
 
 inline void AsyncExecutor::Schedule(std::coroutine_handle<> handle) {
-  state_.handle = handle;
-  async_context_set_work_pending(&state_.context, &state_.worker);
+  timers_.scheduler().Schedule(resumer_, handle);
 }
 
 inline auto AsyncExecutor::Schedule() {
@@ -78,9 +76,9 @@ inline auto AsyncExecutor::Schedule() {
 
 inline void AsyncExecutor::ScheduleAt(absolute_time_t time,
                                       std::coroutine_handle<> handle) {
-  state_.handle = handle;
-  const bool fire_if_past = true;
-  add_alarm_at(time, &AlarmCallback, this, fire_if_past);
+  resumer_.handle = handle;
+  timer_.time = time;
+  timers_.Add(timer_);
 }
 
 inline auto AsyncExecutor::SleepUntil(absolute_time_t time) {
@@ -95,16 +93,101 @@ inline auto AsyncExecutor::SleepUntil(absolute_time_t time) {
   return Sleeper{.executor = *this, .time = time};
 }
 
-inline void AsyncExecutor::ResumeInContext(
-    async_context_t* context, async_when_pending_worker_t* worker) {
-  auto& state = reinterpret_cast<WorkerState&>(*worker);
-  state.handle.resume();
+// Like AsyncExecutor, but manages up to `kSlots` suspended coroutines at once,
+// so that several tasks can share one executor. Schedule() and ScheduleAt()
+// must be called on the async_context, which is where the coroutines are
+// resumed.
+template <std::size_t kSlots>
+class MultiAsyncExecutor {
+ public:
+  // Not thread-safe.
+  MultiAsyncExecutor(async_context_t& context);
+  // Cancels any pending resumptions.
+  ~MultiAsyncExecutor();
+
+  void operator=(const MultiAsyncExecutor&) = delete;
+
+  // As with AsyncExecutor. Panics if all slots are taken.
+  void Schedule(std::coroutine_handle<> handle);
+  auto Schedule();
+  void ScheduleAt(absolute_time_t time, std::coroutine_handle<> handle);
+  auto SleepUntil(absolute_time_t time);
+
+ private:
+  // Free while its handle is null, which the scheduler resets before resuming
+  // the coroutine.
+  struct Slot : Scheduler::Resumer {
+    TimerQueue::Timer timer = {.entry = this};
+  };
+
+  Slot& Claim(std::coroutine_handle<> handle);
+
+  TimerQueue& timers_;
+  std::array<Slot, kSlots> slots_;
+};
+
+template <std::size_t kSlots>
+MultiAsyncExecutor<kSlots>::MultiAsyncExecutor(async_context_t& context)
+    : timers_(TimerQueue::ForContext(context)) {}
+
+template <std::size_t kSlots>
+MultiAsyncExecutor<kSlots>::~MultiAsyncExecutor() {
+  for (Slot& slot : slots_) {
+    if (slot.timer.Pending()) {
+      timers_.Cancel(slot.timer);
+    }
+    if (slot.queued) {
+      timers_.scheduler().Cancel(slot);
+    }
+  }
+}
+
+template <std::size_t kSlots>
+typename MultiAsyncExecutor<kSlots>::Slot& MultiAsyncExecutor<kSlots>::Claim(
+    std::coroutine_handle<> handle) {
+  for (Slot& slot : slots_) {
+    if (!slot.handle) {
+      slot.handle = handle;
+      return slot;
+    }
+  }
+  panic("MultiAsyncExecutor slots exhausted");
+}
+
+template <std::size_t kSlots>
+void MultiAsyncExecutor<kSlots>::Schedule(std::coroutine_handle<> handle) {
+  timers_.scheduler().Schedule(Claim(handle));
+}
+
+template <std::size_t kSlots>
+auto MultiAsyncExecutor<kSlots>::Schedule() {
+  struct Awaiter : std::suspend_always {
+    MultiAsyncExecutor& executor;
+
+    void await_suspend(std::coroutine_handle<> handle) {
+      executor.Schedule(handle);
+    }
+  };
+  return Awaiter{.executor = *this};
+}
+
+template <std::size_t kSlots>
+void MultiAsyncExecutor<kSlots>::ScheduleAt(absolute_time_t time,
+                                            std::coroutine_handle<> handle) {
+  Slot& slot = Claim(handle);
+  slot.timer.time = time;
+  timers_.Add(slot.timer);
 }
 
-inline std::int64_t AsyncExecutor::AlarmCallback(alarm_id_t id,
-                                                 void* user_data) {
-  auto& state = *static_cast<WorkerState*>(user_data);
-  async_context_set_work_pending(&state.context, &state.worker);
-  // Do not reschedule alarm.
-  return 0;
+template <std::size_t kSlots>
+auto MultiAsyncExecutor<kSlots>::SleepUntil(absolute_time_t time) {
+  struct Sleeper : std::suspend_always {
+    MultiAsyncExecutor& executor;
+    absolute_time_t time;
+
+    void await_suspend(std::coroutine_handle<> handle) {
+      executor.ScheduleAt(time, handle);
+    }
+  };
+  return Sleeper{.executor = *this, .time = time};
 }
@@ -1,11 +1,15 @@
 #pragma once
 
-#include <utility>
+#include <pico/async_context.h>
+
+#include <coroutine>
+#include <cstdint>
 
 #include "picopp/critical_section.h"
-#include "picoro/async.h"
+#include "picoro/scheduler.h"
+#include "picoro/waiter_list.h"
 
-// Reusable binary event awaitable.
+// Reusable binary event awaitable. Any number of coroutines may wait on it.
 class Event {
  public:
   // Not thread-safe.
@@ -13,7 +17,7 @@ class Event {
 
   void operator=(const Event&) = delete;
 
-  // Wake any sleeping waiters.
+  // Wake all sleeping waiters. Safe to call from interrupt handlers.
   void Notify();
 
   // Awaitable that suspends the current coroutine until notified. Execution
@@ -23,26 +27,32 @@ class Event {
   auto operator co_await();
 
  private:
-  AsyncExecutor executor_;
+  Scheduler& scheduler_;
 
   CriticalSection mutex_;
   bool notified_ = false;
-  std::coroutine_handle<> waiter_;
+  WaiterList waiters_;
 };
 
-inline Event::Event(async_context_t& context) : executor_(context) {}
+inline Event::Event(async_context_t& context)
+    : scheduler_(Scheduler::ForContext(context)) {}
 
 inline void Event::Notify() {
-  CriticalSectionLock lock(mutex_);
-  notified_ = true;
-  if (waiter_) {
-    executor_.Schedule(std::exchange(waiter_, nullptr));
+  WaiterList waiters;
+  {
+    CriticalSectionLock lock(mutex_);
+    notified_ = true;
+    waiters = waiters_.Take();
   }
+  // The first waiter to resume resets the event, but all of them were waiting
+  // for this notification.
+  waiters.ScheduleAll(scheduler_);
 }
 
 inline auto Event::operator co_await() {
   struct Waiter {
     Event& event;
+    WaiterList::Node node;
 
     bool await_ready() {
       CriticalSectionLock lock(event.mutex_);
@@ -54,7 +64,8 @@ inline auto Event::operator co_await() {
       if (event.notified_) {
         return false;
       }
-      event.waiter_ = handle;
+      node.handle = handle;
+      event.waiters_.Push(node);
       return true;
     }
 
@@ -65,3 +76,101 @@ inline auto Event::operator co_await() {
   };
   return Waiter{.event = *this};
 }
+
+// Notifies any number of subscribers of every change. Unlike a shared Event,
+// where the first waiter to resume consumes the notification, each
+// Subscription sees each Notify(). Notifications arriving while a subscriber
+// is busy are coalesced into a single wakeup.
+class Broadcast {
+ public:
+  class Subscription;
+
+  // Not thread-safe.
+  Broadcast(async_context_t& context);
+
+  void operator=(const Broadcast&) = delete;
+
+  // Wake all subscribers. Safe to call from interrupt handlers.
+  void Notify();
+
+  // A subscription that has seen everything up to now. Must not outlive the
+  // broadcast.
+  Subscription Subscribe();
+
+ private:
+  Scheduler& scheduler_;
+
+  CriticalSection mutex_;
+  // Incremented on every Notify().
+  std::uint32_t generation_ = 0;
+  WaiterList waiters_;
+};
+
+class Broadcast::Subscription {
+ public:
+  // Awaitable that suspends the current coroutine until the broadcast is
+  // notified. Resumes immediately if it was notified since this subscription
+  // last resumed. If not, the coroutine will be resumed on the broadcast's
+  // async_context.
+  auto operator co_await();
+
+ private:
+  friend class Broadcast;
+
+  Subscription(Broadcast& broadcast) : broadcast_(broadcast) {
+    CriticalSectionLock lock(broadcast_.mutex_);
+    seen_ = broadcast_.generation_;
+  }
+
+  Broadcast& broadcast_;
+  // Generation as of the last resumption.
+  std::uint32_t seen_;
+};
+
+inline Broadcast::Broadcast(async_context_t& context)
+    : scheduler_(Scheduler::ForContext(context)) {}
+
+inline void Broadcast::Notify() {
+  WaiterList waiters;
+  {
+    CriticalSectionLock lock(mutex_);
+    ++generation_;
+    // Subscribers only wait once they have seen the previous generation, so
+    // all of them are now behind.
+    waiters = waiters_.Take();
+  }
+  waiters.ScheduleAll(scheduler_);
+}
+
+inline Broadcast::Subscription Broadcast::Subscribe() {
+  return Subscription(*this);
+}
+
+inline auto Broadcast::Subscription::operator co_await() {
+  struct Awaiter {
+    Subscription& subscription;
+    WaiterList::Node node;
+
+    bool await_ready() {
+      CriticalSectionLock lock(subscription.broadcast_.mutex_);
+      return subscription.seen_ != subscription.broadcast_.generation_;
+    }
+
+    bool await_suspend(std::coroutine_handle<> handle) {
+      Broadcast& broadcast = subscription.broadcast_;
+      CriticalSectionLock lock(broadcast.mutex_);
+      if (subscription.seen_ != broadcast.generation_) {
+        return false;
+      }
+      node.handle = handle;
+      broadcast.waiters_.Push(node);
+      return true;
+    }
+
+    void await_resume() {
+      CriticalSectionLock lock(subscription.broadcast_.mutex_);
+      subscription.seen_ = subscription.broadcast_.generation_;
+    }
+  };
+  return Awaiter{.subscription = *this};
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <pico/async_context.h>
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <utility>
+
+#include "picoro/scheduler.h"
+#include "picoro/spsc_ring.h"
+
+// Queue of events from a producer, typically an interrupt handler, to a single
+// awaiting coroutine. Push() doesn't block, and its only lock is the
+// scheduler's, held just long enough to queue the wakeup. The coroutine is
+// resumed on the async_context and receives every event queued since it last
+// awaited, in order.
+//
+// Awaitable directly; wrap with AwaitableReference() when returning it from an
+// operator co_await.
+template <typename T, std::size_t N>
+class EventQueue {
+ public:
+  // Events delivered to one resumption of the awaiting coroutine, oldest
+  // first.
+  struct Batch {
+    std::array<T, N> items;
+    std::size_t size = 0;
+
+    const T* begin() const { return items.data(); }
+    const T* end() const { return items.data() + size; }
+    bool empty() const { return size == 0; }
+    const T& back() const { return items[size - 1]; }
+  };
+
+  // Not thread-safe.
+  EventQueue(async_context_t& context);
+
+  void operator=(const EventQueue&) = delete;
+
+  // Producer side. Returns false, dropping `event`, if the queue is full.
+  bool Push(const T& event);
+
+  bool await_ready() { return !ring_.Empty(); }
+
+  // Runs on the async_context, as does the scheduler entry resuming the
+  // waiter, so the two can't race.
+  void await_suspend(std::coroutine_handle<> handle) {
+    state_.waiter = handle;
+  }
+
+  Batch await_resume();
+
+ private:
+  struct WorkerState {
+    // Note: a standard-layout object is pointer-interconvertible with its first
+    // member.
+    Scheduler::Entry entry;
+    SpscRing<T, N>& ring;
+    std::coroutine_handle<> waiter;
+  };
+
+  // Scheduler callback.
+  static void ResumeInContext(Scheduler::Entry& entry);
+
+  Scheduler& scheduler_;
+  SpscRing<T, N> ring_;
+  WorkerState state_;
+};
+
+template <typename T, std::size_t N>
+EventQueue<T, N>::EventQueue(async_context_t& context)
+    : scheduler_(Scheduler::ForContext(context)),
+      state_({.entry = {.run = &ResumeInContext}, .ring = ring_}) {}
+
+template <typename T, std::size_t N>
+bool EventQueue<T, N>::Push(const T& event) {
+  const bool pushed = ring_.Push(event);
+  scheduler_.Schedule(state_.entry);
+  return pushed;
+}
+
+template <typename T, std::size_t N>
+auto EventQueue<T, N>::await_resume() -> Batch {
+  Batch batch;
+  while (batch.size < N && ring_.Pop(batch.items[batch.size])) {
+    ++batch.size;
+  }
+  return batch;
+}
+
+template <typename T, std::size_t N>
+void EventQueue<T, N>::ResumeInContext(Scheduler::Entry& entry) {
+  auto& state = reinterpret_cast<WorkerState&>(entry);
+  if (state.waiter && !state.ring.Empty()) {
+    std::exchange(state.waiter, nullptr).resume();
+  }
+}
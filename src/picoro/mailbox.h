@@ -0,0 +1,63 @@
+#pragma once
+
+#include <pico/async_context.h>
+
+#include <coroutine>
+#include <utility>
+
+#include "picopp/critical_section.h"
+#include "picoro/event.h"
+
+// Latest-value channel to coroutines on an async_context from another core or
+// an interrupt handler. Posting replaces the value and wakes the readers.
+// Readers that fall behind skip straight to the latest value, which suits
+// state that supersedes itself, like a setpoint, where a FIFO such as
+// EventQueue would fill up and drop the newest.
+template <typename T>
+class Mailbox {
+ public:
+  // Not thread-safe. Readers are resumed on `context`.
+  Mailbox(async_context_t& context, T initial = {})
+      : posted_(context), value_(std::move(initial)) {}
+
+  void operator=(const Mailbox&) = delete;
+
+  // Safe to call from any core and from interrupt handlers.
+  void Post(const T& value) {
+    {
+      CriticalSectionLock lock(mutex_);
+      value_ = value;
+    }
+    posted_.Notify();
+  }
+
+  // The latest value, without waiting.
+  T Peek() {
+    CriticalSectionLock lock(mutex_);
+    return value_;
+  }
+
+  // Awaitable that resumes with the latest value once one has been posted
+  // since the last resumption. Must be awaited on the async_context.
+  auto operator co_await() {
+    struct Awaiter {
+      Mailbox& mailbox;
+      decltype(std::declval<Event&>().operator co_await()) posted;
+
+      bool await_ready() { return posted.await_ready(); }
+      bool await_suspend(std::coroutine_handle<> handle) {
+        return posted.await_suspend(handle);
+      }
+      T await_resume() {
+        posted.await_resume();
+        return mailbox.Peek();
+      }
+    };
+    return Awaiter{.mailbox = *this, .posted = posted_.operator co_await()};
+  }
+
+ private:
+  Event posted_;
+  CriticalSection mutex_;
+  T value_;
+};
@@ -0,0 +1,195 @@
+#pragma once
+
+#include <pico/async_context.h>
+#include <pico/platform.h>
+
+#include <array>
+#include <coroutine>
+#include <optional>
+#include <utility>
+
+#include "picopp/critical_section.h"
+
+// Runs ready work on an async_context through a single when-pending worker.
+// Ready entries wait in an intrusive FIFO, so a wakeup costs O(1) regardless
+// of how many coroutines or primitives share the context, whereas the SDK
+// walks every registered worker on each poll.
+//
+// The picoro primitives share one scheduler per context, obtained with
+// ForContext().
+class Scheduler {
+ public:
+  // Unit of ready work. Embedded in whatever needs waking, which must keep it
+  // alive until it runs.
+  struct Entry {
+    // Called on the async_context.
+    void (*run)(Entry& entry);
+    Entry* next = nullptr;
+    // Whether the entry is in the ready queue.
+    bool queued = false;
+  };
+
+  // Entry that resumes a suspended coroutine.
+  struct Resumer : Entry {
+    Resumer() : Entry{.run = &Resume} {}
+
+    std::coroutine_handle<> handle;
+
+   private:
+    static void Resume(Entry& entry) {
+      // The coroutine may well reuse the entry.
+      std::exchange(static_cast<Resumer&>(entry).handle, nullptr).resume();
+    }
+  };
+
+  // The scheduler for `context`, created on first use. At most one context
+  // per core is supported. Not thread-safe.
+  static Scheduler& ForContext(async_context_t& context);
+
+  // Prefer ForContext(); a context needs only one scheduler. Not thread-safe.
+  Scheduler(async_context_t& context);
+  ~Scheduler();
+
+  void operator=(const Scheduler&) = delete;
+
+  // Queues `entry` to run on the async_context, unless it is already queued.
+  // Safe to call from interrupt handlers and the other core.
+  void Schedule(Entry& entry);
+
+  // Removes `entry` from the ready queue if it is queued, e.g. before
+  // destroying it. Linear in the length of the queue.
+  void Cancel(Entry& entry);
+
+  // Schedules a resumer for the given coroutine.
+  void Schedule(Resumer& resumer, std::coroutine_handle<> handle) {
+    resumer.handle = handle;
+    Schedule(resumer);
+  }
+
+  async_context_t& context() { return state_.context; }
+
+ private:
+  struct WorkerState {
+    // Note: a standard-layout object is pointer-interconvertible with its first
+    // member.
+    async_when_pending_worker_t worker;
+    async_context_t& context;
+    Scheduler& scheduler;
+  };
+
+  // Runs the entries that were ready when called. Entries queued meanwhile
+  // run on the next poll, so that a coroutine that keeps yielding doesn't
+  // starve the rest of the context.
+  void RunReady();
+
+  // async_context worker callback.
+  static void RunInContext(async_context_t* context,
+                           async_when_pending_worker_t* worker);
+
+  CriticalSection mutex_;
+  Entry* head_ = nullptr;
+  Entry* tail_ = nullptr;
+  WorkerState state_;
+};
+
+inline Scheduler& Scheduler::ForContext(async_context_t& context) {
+  static std::array<std::optional<Scheduler>, 2> schedulers;
+  for (auto& scheduler : schedulers) {
+    if (scheduler && &scheduler->context() == &context) {
+      return *scheduler;
+    }
+  }
+  for (auto& scheduler : schedulers) {
+    if (!scheduler) {
+      return scheduler.emplace(context);
+    }
+  }
+  panic("Too many async_contexts for Scheduler");
+}
+
+inline Scheduler::Scheduler(async_context_t& context)
+    : state_({.worker = {.do_work = &RunInContext, .work_pending = false},
+              .context = context,
+              .scheduler = *this}) {
+  async_context_add_when_pending_worker(&state_.context, &state_.worker);
+}
+
+inline Scheduler::~Scheduler() {
+  async_context_remove_when_pending_worker(&state_.context, &state_.worker);
+}
+
+inline void Scheduler::Schedule(Entry& entry) {
+  {
+    CriticalSectionLock lock(mutex_);
+    if (entry.queued) {
+      return;
+    }
+    entry.queued = true;
+    entry.next = nullptr;
+    if (tail_) {
+      tail_->next = &entry;
+    } else {
+      head_ = &entry;
+    }
+    tail_ = &entry;
+  }
+  async_context_set_work_pending(&state_.context, &state_.worker);
+}
+
+inline void Scheduler::Cancel(Entry& entry) {
+  CriticalSectionLock lock(mutex_);
+  if (!entry.queued) {
+    return;
+  }
+  entry.queued = false;
+  Entry* previous = nullptr;
+  for (Entry** link = &head_; *link; link = &(*link)->next) {
+    if (*link == &entry) {
+      *link = entry.next;
+      if (tail_ == &entry) {
+        tail_ = previous;
+      }
+      return;
+    }
+    previous = *link;
+  }
+}
+
+inline void Scheduler::RunReady() {
+  Entry* last;
+  {
+    CriticalSectionLock lock(mutex_);
+    last = tail_;
+  }
+  if (!last) {
+    return;
+  }
+  while (true) {
+    Entry* entry;
+    {
+      CriticalSectionLock lock(mutex_);
+      entry = head_;
+      // `last` itself may have been cancelled.
+      if (!entry) {
+        return;
+      }
+      head_ = entry->next;
+      if (!head_) {
+        tail_ = nullptr;
+      }
+      // Allows the entry to be queued again while it runs.
+      entry->queued = false;
+    }
+    // The entry may be gone once it runs.
+    const bool done = entry == last;
+    entry->run(*entry);
+    if (done) {
+      return;
+    }
+  }
+}
+
+inline void Scheduler::RunInContext(async_context_t* context,
+                                    async_when_pending_worker_t* worker) {
+  reinterpret_cast<WorkerState&>(*worker).scheduler.RunReady();
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer ring buffer. The producer and the
+// consumer may be an interrupt handler and a coroutine, or run on different
+// cores, without either taking a lock; neither side may be shared.
+//
+// N must be a power of two.
+template <typename T, std::size_t N>
+class SpscRing {
+  static_assert(N > 0 && (N & (N - 1)) == 0, "N must be a power of two");
+
+ public:
+  // Producer side. Returns false, dropping `value`, if the ring is full.
+  bool Push(const T& value);
+
+  // Consumer side. Returns false if the ring is empty.
+  bool Pop(T& value);
+
+  // Consumer side.
+  bool Empty() const {
+    return head_.load(std::memory_order_acquire) ==
+           tail_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  std::array<T, N> items_;
+  // Free-running counts of pushed and popped items. Only the producer writes
+  // `head_` and only the consumer writes `tail_`.
+  std::atomic<std::uint32_t> head_ = 0;
+  std::atomic<std::uint32_t> tail_ = 0;
+};
+
+template <typename T, std::size_t N>
+bool SpscRing<T, N>::Push(const T& value) {
+  const std::uint32_t head = head_.load(std::memory_order_relaxed);
+  if (head - tail_.load(std::memory_order_acquire) == N) {
+    return false;
+  }
+  items_[head % N] = value;
+  head_.store(head + 1, std::memory_order_release);
+  return true;
+}
+
+template <typename T, std::size_t N>
+bool SpscRing<T, N>::Pop(T& value) {
+  const std::uint32_t tail = tail_.load(std::memory_order_relaxed);
+  if (head_.load(std::memory_order_acquire) == tail) {
+    return false;
+  }
+  value = items_[tail % N];
+  tail_.store(tail + 1, std::memory_order_release);
+  return true;
+}
@@ -2,6 +2,7 @@
 
 #include <coroutine>
 #include <cstdint>
+#include <utility>
 
 #include "picopp/critical_section.h"
 
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <pico/async_context.h>
+#include <pico/platform.h>
+#include <pico/time.h>
+
+#include <array>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "picoro/scheduler.h"
+
+// Pending wakeups ordered by time, all driven by a single async_context
+// at-time worker instead of an alarm, and its interrupt, per sleep. The timers
+// are intrusive and kept in a binary min-heap of pointers, so adding or
+// cancelling one is O(log n) in the number pending.
+//
+// Expired timers schedule their entry on the context's Scheduler. All methods
+// must be called on the async_context.
+class TimerQueue {
+ public:
+  static constexpr std::size_t kIdle = SIZE_MAX;
+
+  // Typically embedded next to `entry`, both of which must stay alive until
+  // the timer expires or is cancelled.
+  struct Timer {
+    absolute_time_t time;
+    Scheduler::Entry* entry;
+    // Position in the heap, or kIdle if not pending.
+    std::size_t index = kIdle;
+
+    bool Pending() const { return index != kIdle; }
+  };
+
+  // The timer queue for `context`, created on first use. At most one context
+  // per core is supported. Not thread-safe.
+  static TimerQueue& ForContext(async_context_t& context);
+
+  // Prefer ForContext(). Not thread-safe.
+  TimerQueue(async_context_t& context);
+  ~TimerQueue();
+
+  void operator=(const TimerQueue&) = delete;
+
+  // Schedules `timer.entry` at `timer.time`, or on the next poll if that is in
+  // the past. The timer must not already be pending.
+  void Add(Timer& timer);
+
+  // Returns whether the timer was pending.
+  bool Cancel(Timer& timer);
+
+  std::size_t Size() const { return heap_.size(); }
+
+  Scheduler& scheduler() { return scheduler_; }
+
+ private:
+  struct WorkerState {
+    // Note: a standard-layout object is pointer-interconvertible with its first
+    // member.
+    async_at_time_worker_t worker;
+    async_context_t& context;
+    TimerQueue& queue;
+  };
+
+  static bool Before(const Timer* a, const Timer* b) {
+    return to_us_since_boot(a->time) < to_us_since_boot(b->time);
+  }
+
+  void Place(Timer* timer, std::size_t index) {
+    heap_[index] = timer;
+    timer->index = index;
+  }
+
+  void SiftUp(std::size_t index);
+  void SiftDown(std::size_t index);
+  void Remove(std::size_t index);
+
+  // Points the worker at the earliest timer.
+  void Rearm();
+
+  // Schedules the expired timers.
+  void Expire();
+
+  // async_context worker callback.
+  static void ExpireInContext(async_context_t* context,
+                              async_at_time_worker_t* worker);
+
+  Scheduler& scheduler_;
+  std::vector<Timer*> heap_;
+  WorkerState state_;
+};
+
+// Awaitable that resumes the current coroutine on `context` at `time`. Needs no
+// executor as the timer lives in the awaiter. Destroying the suspended
+// coroutine cancels the sleep.
+auto SleepUntil(async_context_t& context, absolute_time_t time);
+
+inline TimerQueue& TimerQueue::ForContext(async_context_t& context) {
+  static std::array<std::optional<TimerQueue>, 2> queues;
+  for (auto& queue : queues) {
+    if (queue && &queue->state_.context == &context) {
+      return *queue;
+    }
+  }
+  for (auto& queue : queues) {
+    if (!queue) {
+      return queue.emplace(context);
+    }
+  }
+  panic("Too many async_contexts for TimerQueue");
+}
+
+inline TimerQueue::TimerQueue(async_context_t& context)
+    : scheduler_(Scheduler::ForContext(context)),
+      state_({.worker = {.do_work = &ExpireInContext}, .context = context,
+              .queue = *this}) {}
+
+inline TimerQueue::~TimerQueue() {
+  async_context_remove_at_time_worker(&state_.context, &state_.worker);
+}
+
+inline void TimerQueue::Add(Timer& timer) {
+  if (timer.Pending()) {
+    panic("Timer already pending");
+  }
+  heap_.push_back(&timer);
+  timer.index = heap_.size() - 1;
+  SiftUp(timer.index);
+  if (heap_.front() == &timer) {
+    Rearm();
+  }
+}
+
+inline bool TimerQueue::Cancel(Timer& timer) {
+  if (!timer.Pending()) {
+    return false;
+  }
+  const bool was_first = timer.index == 0;
+  Remove(timer.index);
+  if (was_first) {
+    Rearm();
+  }
+  return true;
+}
+
+inline void TimerQueue::SiftUp(std::size_t index) {
+  Timer* timer = heap_[index];
+  while (index > 0) {
+    const std::size_t parent = (index - 1) / 2;
+    if (!Before(timer, heap_[parent])) {
+      break;
+    }
+    Place(heap_[parent], index);
+    index = parent;
+  }
+  Place(timer, index);
+}
+
+inline void TimerQueue::SiftDown(std::size_t index) {
+  Timer* timer = heap_[index];
+  while (true) {
+    std::size_t child = 2 * index + 1;
+    if (child >= heap_.size()) {
+      break;
+    }
+    if (child + 1 < heap_.size() && Before(heap_[child + 1], heap_[child])) {
+      ++child;
+    }
+    if (!Before(heap_[child], timer)) {
+      break;
+    }
+    Place(heap_[child], index);
+    index = child;
+  }
+  Place(timer, index);
+}
+
+inline void TimerQueue::Remove(std::size_t index) {
+  heap_[index]->index = kIdle;
+  Timer* last = heap_.back();
+  heap_.pop_back();
+  if (index == heap_.size()) {
+    return;
+  }
+  // Move the last timer into the hole, which may need to go either way.
+  Place(last, index);
+  SiftUp(index);
+  SiftDown(last->index);
+}
+
+inline void TimerQueue::Rearm() {
+  if (heap_.empty()) {
+    async_context_remove_at_time_worker(&state_.context, &state_.worker);
+    return;
+  }
+  // Replaces any earlier time.
+  async_context_add_at_time_worker_at(&state_.context, &state_.worker,
+                                      heap_.front()->time);
+}
+
+inline void TimerQueue::Expire() {
+  const std::uint64_t now_us = to_us_since_boot(get_absolute_time());
+  while (!heap_.empty() && to_us_since_boot(heap_.front()->time) <= now_us) {
+    Scheduler::Entry& entry = *heap_.front()->entry;
+    Remove(0);
+    scheduler_.Schedule(entry);
+  }
+  Rearm();
+}
+
+inline void TimerQueue::ExpireInContext(async_context_t* context,
+                                        async_at_time_worker_t* worker) {
+  reinterpret_cast<WorkerState&>(*worker).queue.Expire();
+}
+
+inline auto SleepUntil(async_context_t& context, absolute_time_t time) {
+  struct Sleeper : std::suspend_always {
+    TimerQueue& queue;
+    Scheduler::Resumer resumer;
+    TimerQueue::Timer timer;
+
+    ~Sleeper() {
+      queue.Cancel(timer);
+      queue.scheduler().Cancel(resumer);
+    }
+
+    void await_suspend(std::coroutine_handle<> handle) {
+      resumer.handle = handle;
+      timer.entry = &resumer;
+      queue.Add(timer);
+    }
+  };
+  return Sleeper{.queue = TimerQueue::ForContext(context),
+                 .timer = {.time = time}};
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include <utility>
+
+#include "picoro/scheduler.h"
+
+// Intrusive FIFO of suspended coroutines. Each node lives in the awaiter of
+// its coroutine, which stays alive in the coroutine frame while suspended, so
+// any number of coroutines can wait without allocating.
+//
+// Not thread-safe.
+class WaiterList {
+ public:
+  using Node = Scheduler::Resumer;
+
+  WaiterList() = default;
+  WaiterList(WaiterList&& other)
+      : head_(std::exchange(other.head_, nullptr)),
+        tail_(std::exchange(other.tail_, nullptr)) {}
+
+  // Only meant to replace an empty list.
+  WaiterList& operator=(WaiterList&& other) {
+    head_ = std::exchange(other.head_, nullptr);
+    tail_ = std::exchange(other.tail_, nullptr);
+    return *this;
+  }
+
+  bool Empty() const { return head_ == nullptr; }
+
+  void Push(Node& node) {
+    node.next = nullptr;
+    if (tail_) {
+      tail_->next = &node;
+    } else {
+      head_ = &node;
+    }
+    tail_ = &node;
+  }
+
+  // Removes and returns all waiters, e.g. to schedule them outside of a lock.
+  WaiterList Take() { return std::move(*this); }
+
+  // Schedules all waiters for resumption, in order, and empties the list.
+  void ScheduleAll(Scheduler& scheduler) {
+    Scheduler::Entry* node = std::exchange(head_, nullptr);
+    tail_ = nullptr;
+    while (node) {
+      // The scheduler reuses `next`.
+      Scheduler::Entry* next = node->next;
+      scheduler.Schedule(*node);
+      node = next;
+    }
+  }
+
+ private:
+  Scheduler::Entry* head_ = nullptr;
+  Scheduler::Entry* tail_ = nullptr;
+};
@@ -0,0 +1,113 @@
+#include "probe.h"
+
+#include <hardware/timer.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+
+namespace probe {
+namespace {
+
+// Times are kept to 32 bits, which the RP2040 can store atomically. Durations
+// are computed modulo 2^32 us, so they are only wrong beyond 71 minutes.
+using Time = std::uint32_t;
+
+// Bucket i > 0 counts durations in [2^(i-1), 2^i) us, and bucket 0 counts
+// zeros. The last bucket also takes anything longer.
+constexpr std::size_t kNumBuckets = 21;
+
+constexpr const char* kHistogramNames[] = {
+    "encoder poll", "detent to resume", "detent to step rate",
+    "frame render", "frame transfer",
+};
+static_assert(std::size(kHistogramNames) ==
+              static_cast<std::size_t>(Histogram::kCount));
+
+// Counters are only written by one core, so increments don't need to be
+// atomic read-modify-writes; the atomics just keep Print() from seeing torn
+// values.
+struct HistogramState {
+  std::array<std::atomic<Time>, kNumBuckets> buckets = {};
+  std::atomic<std::uint32_t> count = 0;
+  std::atomic<Time> sum_us = 0;
+  std::atomic<Time> max_us = 0;
+  // Stamp last recorded by Since().
+  Time measured_stamp = 0;
+
+  void Add(Time elapsed_us) {
+    const auto increment = [](std::atomic<std::uint32_t>& value,
+                              std::uint32_t amount) {
+      value.store(value.load(std::memory_order_relaxed) + amount,
+                  std::memory_order_relaxed);
+    };
+    const std::size_t bucket =
+        std::min<std::size_t>(std::bit_width(elapsed_us), kNumBuckets - 1);
+    increment(buckets[bucket], 1);
+    increment(count, 1);
+    increment(sum_us, elapsed_us);
+    if (elapsed_us > max_us.load(std::memory_order_relaxed)) {
+      max_us.store(elapsed_us, std::memory_order_relaxed);
+    }
+  }
+};
+
+// Zero means never stamped.
+std::array<std::atomic<Time>, static_cast<std::size_t>(Point::kCount)> stamps;
+std::array<HistogramState, static_cast<std::size_t>(Histogram::kCount)>
+    histograms;
+
+}  // namespace
+
+void Stamp(Point point, std::uint64_t time_us) {
+  // Avoid the reserved zero, at the cost of a microsecond.
+  const Time time = static_cast<Time>(time_us) | (time_us == 0);
+  stamps[static_cast<std::size_t>(point)].store(time,
+                                                std::memory_order_relaxed);
+}
+
+void Stamp(Point point) { Stamp(point, time_us_64()); }
+
+void Since(Point point, Histogram histogram) {
+  const Time now = time_us_64();
+  const Time stamp =
+      stamps[static_cast<std::size_t>(point)].load(std::memory_order_relaxed);
+  HistogramState& state = histograms[static_cast<std::size_t>(histogram)];
+  if (stamp == 0 || stamp == state.measured_stamp) {
+    return;
+  }
+  state.measured_stamp = stamp;
+  state.Add(now - stamp);
+}
+
+void Record(Histogram histogram, std::uint64_t elapsed_us) {
+  histograms[static_cast<std::size_t>(histogram)].Add(elapsed_us);
+}
+
+void Print(std::ostream& out) {
+  out << "Latency histograms (us):\n";
+  for (std::size_t i = 0; i < histograms.size(); ++i) {
+    const HistogramState& state = histograms[i];
+    const std::uint32_t count = state.count.load(std::memory_order_relaxed);
+    out << kHistogramNames[i] << ": count " << count;
+    if (count == 0) {
+      out << '\n';
+      continue;
+    }
+    out << ", mean " << state.sum_us.load(std::memory_order_relaxed) / count
+        << ", max " << state.max_us.load(std::memory_order_relaxed) << '\n';
+    for (std::size_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+      const Time n = state.buckets[bucket].load(std::memory_order_relaxed);
+      if (n == 0) {
+        continue;
+      }
+      const Time low = bucket == 0 ? 0 : Time{1} << (bucket - 1);
+      out << "  >= " << low << ": " << n << '\n';
+    }
+  }
+}
+
+}  // namespace probe
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+
+// Latency instrumentation for the hot paths. Stamp() records when something
+// happened at a probe point, and Since() adds the time elapsed from the latest
+// stamp to a histogram. Both cost a timer read and a few stores, and are safe
+// to call from interrupt handlers.
+//
+// Each histogram must only be recorded from one core, though Print() may run
+// on either.
+namespace probe {
+
+enum class Point : std::uint8_t {
+  // A detent completed. The interrupt decoder stamps the edge itself. The PIO
+  // decoder only sees detents when polled, so it stamps the previous poll,
+  // the earliest the edge could have been; latencies from this point are
+  // upper bounds by up to one poll interval.
+  kDetent,
+  // UpdateTask started drawing a frame.
+  kRenderStart,
+  // UpdateTask started sending a frame to the display.
+  kTransferStart,
+  kCount,
+};
+
+enum class Histogram : std::uint8_t {
+  // Run time of a PIO encoder poll that found detents.
+  kEncoderPoll,
+  // Detent to the first resumption of the awaiting coroutine after it.
+  kDetentToResume,
+  // Detent to the first SpeedControl::Set() after it.
+  kDetentToStepRate,
+  // Drawing a frame into the buffer.
+  kRender,
+  // Sending a frame over SPI, until the transfer is done.
+  kTransfer,
+  kCount,
+};
+
+void Stamp(Point point, std::uint64_t time_us);
+void Stamp(Point point);
+
+// Records the time since `point` was last stamped, unless that stamp has
+// already been recorded into `histogram` or there is none.
+void Since(Point point, Histogram histogram);
+
+// Records a duration measured by the caller.
+void Record(Histogram histogram, std::uint64_t elapsed_us);
+
+// Writes each histogram's count, mean, max and power-of-two buckets.
+void Print(std::ostream& out);
+
+}  // namespace probe
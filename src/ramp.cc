@@ -0,0 +1,72 @@
+#include "ramp.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+// How far `velocity` lies beyond the band at or below `start`, keeping its
+// sign, or 0 within the band.
+double BeyondStart(double velocity, double start) {
+  if (std::abs(velocity) <= start) {
+    return 0;
+  }
+  return velocity - std::copysign(start, velocity);
+}
+
+// Largest acceleration `a` from which the steps a, a - delta_accel,
+// a - 2 * delta_accel, ... down to the last positive one add up to no more
+// than `steps`, the velocity change left in units of the time step. Ending a
+// ramp this way keeps every change of acceleration within `delta_accel`,
+// including the last one to zero.
+double StoppingAcceleration(double steps, double delta_accel) {
+  // Number of positive steps; n of them add up to at most
+  // delta_accel * n * (n + 1) / 2.
+  const double n = std::max(
+      1.0, std::ceil((std::sqrt(1 + 8 * steps / delta_accel) - 1) / 2));
+  if (n == 1) {
+    return steps;
+  }
+  return steps / n + (n - 1) * delta_accel / 2;
+}
+
+}  // namespace
+
+double Ramp::Step(double dt) {
+  if (Done()) {
+    return velocity_;
+  }
+  const double start = limits_.start_velocity;
+  if (std::abs(target_) <= start && std::abs(velocity_) <= start) {
+    velocity_ = target_;
+    acceleration_ = 0;
+    return velocity_;
+  }
+
+  // The band below the start velocity is skipped over instead of crept
+  // through; very slow step rates would otherwise hold a single long pulse
+  // period. Planning the profile over the velocity beyond the band accounts
+  // for the skip, so that a reversal still ends within the jerk limit.
+  const double target = BeyondStart(target_, start);
+  double beyond = BeyondStart(velocity_, start);
+  const double error = target - beyond;
+
+  // Head for the acceleration that ramps down onto the target exactly, as fast
+  // as the jerk allows.
+  const double max_accel = limits_.max_acceleration;
+  const double delta_accel = limits_.max_jerk * dt;
+  const double stopping = std::copysign(
+      StoppingAcceleration(std::abs(error) / dt, delta_accel), error);
+  acceleration_ = std::clamp(std::clamp(stopping, acceleration_ - delta_accel,
+                                        acceleration_ + delta_accel),
+                             -max_accel, max_accel);
+
+  beyond += acceleration_ * dt;
+  if ((error > 0 && beyond >= target) || (error < 0 && beyond <= target)) {
+    velocity_ = target_;
+    acceleration_ = 0;
+    return velocity_;
+  }
+  velocity_ = beyond + std::copysign(start, beyond != 0 ? beyond : error);
+  return velocity_;
+}
@@ -0,0 +1,37 @@
+#pragma once
+
+// Jerk-limited (S-curve) velocity profile generator. The profile is advanced
+// in fixed time steps; each step yields the velocity to command for the
+// following interval. Units are arbitrary but must be consistent, e.g. steps/s,
+// steps/s^2 and steps/s^3.
+class Ramp {
+ public:
+  struct Limits {
+    // Velocities with a magnitude at or below this are reached immediately,
+    // e.g. the pull-in rate of a stepper motor. Also used to pass through zero
+    // on reversals.
+    double start_velocity;
+    double max_acceleration;
+    // Rate of change of acceleration. Infinity yields a trapezoidal profile.
+    double max_jerk;
+  };
+
+  Ramp(Limits limits) : limits_(limits) {}
+
+  void SetTarget(double velocity) { target_ = velocity; }
+  double Target() const { return target_; }
+
+  double Velocity() const { return velocity_; }
+
+  // True if the current velocity is the target velocity.
+  bool Done() const { return velocity_ == target_ && acceleration_ == 0; }
+
+  // Advances the profile by `dt` seconds and returns the new velocity.
+  double Step(double dt);
+
+ private:
+  const Limits limits_;
+  double target_ = 0;
+  double velocity_ = 0;
+  double acceleration_ = 0;
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "fixed_exp2.h"
+
+// Fixed-width decimal formatting for the speed readout, without allocating or
+// touching iostreams. The readout always has four digits and a decimal point,
+// e.g. "0.125", "2.500", "12.35", "123.4" or "1234.", so that digits keep
+// their positions as the value changes.
+struct Readout {
+  static constexpr std::size_t kWidth = 5;
+
+  std::array<char, kWidth> chars;
+
+  constexpr std::string_view View() const {
+    return {chars.data(), chars.size()};
+  }
+
+  bool operator==(const Readout&) const = default;
+};
+
+// Formats `value`, rounded to the most decimals that fit: three below 10,
+// down to none from 1000. Values below 0.0005 show as "0.000", and 9999.5 or
+// more as "9999.".
+constexpr Readout FormatReadout(Q32 value) {
+  constexpr std::uint64_t kDigitLimit = 10'000;
+  // Start from the most decimals, and drop one each time the rounded value
+  // has too many digits.
+  int decimals = 3;
+  std::uint64_t scale = 1'000;
+  std::uint64_t digits = 0;
+  while (true) {
+    // Below 2^46, so that multiplying by the scale can't overflow.
+    const Q32 clamped = value < (Q32{1} << 46) ? value : Q32{1} << 46;
+    digits = (clamped * scale + (Q32{1} << (kQ32FractionBits - 1))) >>
+             kQ32FractionBits;
+    if (digits < kDigitLimit) {
+      break;
+    }
+    if (decimals == 0) {
+      digits = kDigitLimit - 1;
+      break;
+    }
+    --decimals;
+    scale /= 10;
+  }
+  Readout readout = {};
+  // Fill from the right, putting the point after the integer digits.
+  const std::size_t point = Readout::kWidth - 1 - decimals;
+  for (std::size_t i = Readout::kWidth; i-- > 0;) {
+    if (i == point) {
+      readout.chars[i] = '.';
+      continue;
+    }
+    readout.chars[i] = static_cast<char>('0' + digits % 10);
+    digits /= 10;
+  }
+  return readout;
+}
+
+static_assert(FormatReadout(ToQ32(1) / 8).View() == "0.125");
+static_assert(FormatReadout(ToQ32(5) / 2).View() == "2.500");
+static_assert(FormatReadout(ToQ32(9'999) / 1'000 + 1).View() == "9.999");
+static_assert(FormatReadout(ToQ32(99'999) / 10'000).View() == "10.00");
+static_assert(FormatReadout(ToQ32(1'234)).View() == "1234.");
+static_assert(FormatReadout(ToQ32(100'000)).View() == "9999.");
+static_assert(FormatReadout(0).View() == "0.000");
@@ -1,5 +1,9 @@
 #include "rotary_encoder.h"
 
+#include <utility>
+
+#include "quadrature_encoder.pio.h"
+
 namespace {
 // Mapping of `abAB` values to fractional counter increments, where `ab` are the
 // bits representing the previous readings of the encoder pins, and `AB` are the
@@ -28,6 +32,16 @@ constexpr auto kIncrementsTable = IncrementsTable();
 
 constexpr std::uint32_t kPinEventMask = GPIO_IRQ_EDGE_RISE | GPIO_IRQ_EDGE_FALL;
 
+// Pulses per full detent.
+constexpr int kPulsesPerDetent = 4;
+
+// Loads the decoder program on first use. It must be loaded at offset 0.
+unsigned QuadratureEncoderProgramOffset(PIO pio) {
+  static const unsigned offset =
+      pio_add_program(pio, &quadrature_encoder_program);
+  return offset;
+}
+
 }  // namespace
 
 void RotaryEncoder::State::Init(irq_handler_t edge_interrupt_handler) {
@@ -40,6 +54,7 @@ void RotaryEncoder::State::Init(irq_handler_t edge_interrupt_handler) {
 }
 
 void RotaryEncoder::State::HandleInterrupt() {
+  const std::uint64_t time_us = time_us_64();
   const std::bitset<2> previous_values = values;
   const std::bitset<32> all_gpio_values = gpio_get_all();
   for (int i : {0, 1}) {
@@ -54,13 +69,49 @@ void RotaryEncoder::State::HandleInterrupt() {
     return;
   }
   fractional_counter += increment;
-  // Pulses per full detent.
-  const int divisor = 4;
-  if (std::abs(fractional_counter) != divisor) {
+  if (std::abs(fractional_counter) != kPulsesPerDetent) {
     return;
   }
   // Full detent completed.
-  counter += fractional_counter / divisor;
+  counter += fractional_counter / kPulsesPerDetent;
   fractional_counter = 0;
-  waiter->Send(counter);
+  probe::Stamp(probe::Point::kDetent, time_us);
+  waiter->Send(counter, time_us);
+}
+
+void RotaryEncoder::PioState::Init(unsigned pin_a, unsigned pin_b) {
+  pio = pio1;
+  const unsigned offset = QuadratureEncoderProgramOffset(pio);
+  sm = pio_claim_unused_sm(pio, true);
+  for (unsigned pin : {pin_a, pin_b}) {
+    gpio_init(pin);
+    gpio_pull_up(pin);
+  }
+  quadrature_encoder_program_init(pio, sm, offset, pin_a, pin_b);
+}
+
+void RotaryEncoder::PioState::Poll() {
+  const std::uint64_t time_us = time_us_64();
+  // The detents were completed at some point since the previous poll, which
+  // is taken as the edge time so that latencies aren't understated.
+  const std::uint64_t previous_poll_us = std::exchange(last_poll_us, time_us);
+  // The state machine pushes its count continuously, so the FIFO is usually
+  // full of stale counts. Drain it, plus one more for a fresh count.
+  std::uint32_t position = 0;
+  for (unsigned n = pio_sm_get_rx_fifo_level(pio, sm) + 1; n > 0; --n) {
+    position = pio_sm_get_blocking(pio, sm);
+  }
+  // As with the interrupt decoder, a detent is completed by moving a full
+  // detent's worth of pulses from the previous one.
+  const int detents = static_cast<std::int32_t>(position - detent_position) /
+                      kPulsesPerDetent;
+  if (detents == 0) {
+    return;
+  }
+  detent_position += detents * kPulsesPerDetent;
+  counter += detents;
+  probe::Stamp(probe::Point::kDetent,
+               previous_poll_us != 0 ? previous_poll_us : time_us);
+  waiter->Send(counter, time_us);
+  probe::Record(probe::Histogram::kEncoderPoll, time_us_64() - time_us);
 }
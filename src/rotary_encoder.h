@@ -1,8 +1,9 @@
 #pragma once
 
 #include <hardware/gpio.h>
+#include <hardware/pio.h>
+#include <hardware/timer.h>
 #include <pico/async_context.h>
-#include <pico/sync.h>
 
 #include <array>
 #include <bitset>
@@ -12,10 +13,11 @@
 #include <optional>
 #include <utility>
 
-#include "picopp/critical_section.h"
+#include "picopp/async.h"
 #include "picopp/irq.h"
-#include "picoro/async.h"
 #include "picoro/awaitable_reference.h"
+#include "picoro/event_queue.h"
+#include "probe.h"
 
 // Interrupt-based incremental rotary encoder reader. Accepting the pin numbers
 // as template arguments rather than runtime parameters allows us to instantiate
@@ -35,67 +37,103 @@ class RotaryEncoder {
   template <unsigned pin_a, unsigned pin_b>
   static RotaryEncoder Create(async_context_t& context);
 
+  // Equivalent of Create() that decodes the quadrature signal on a PIO state
+  // machine instead of interrupting on every edge. The count is polled from
+  // `context` every kPollIntervalUs, and awaiting coroutines are only woken
+  // once a full detent has been completed.
+  //
+  // All such encoders share pio1, whose instruction memory the decoder program
+  // mostly fills.
+  template <unsigned pin_a, unsigned pin_b>
+  static RotaryEncoder CreatePio(async_context_t& context);
+
+  static constexpr std::uint32_t kPollIntervalUs = 5'000;
+
   // Awaits an update to the rotary encoder dedent count (int64).
   auto operator co_await();
 
+  // Estimated turning speed in detents per second, signed by direction, as of
+  // the latest detent. Zero once the encoder has been idle for kIdleUs.
+  double Rate() const;
+
+  static constexpr std::uint64_t kIdleUs = 250'000;
+
  private:
   class Waiter;
   struct State;
+  struct PioState;
 
-  RotaryEncoder(State* state) : state_(state) {}
-  State* state_;
+  RotaryEncoder(Waiter& waiter) : waiter_(&waiter) {}
+  Waiter* waiter_;
 };
 
 // Internal implementation details below.
 
-// Waits for counter updates from interrupts.
+// Collects detents from the decoder and tracks the turning speed. Detents are
+// queued without locking, so that none of their timestamps are lost, and are
+// only processed once the awaiting coroutine resumes.
 class RotaryEncoder::Waiter {
  public:
-  Waiter(async_context_t& context) : executor_(context) {}
+  Waiter(async_context_t& context) : detents_(context) {}
 
-  bool await_ready() {
-    CriticalSectionLock lock(mutex_);
-    return counter_.has_value();
-  }
+  bool await_ready() { return detents_.await_ready(); }
 
-  bool await_suspend(std::coroutine_handle<> handle) {
-    CriticalSectionLock lock(mutex);
-    if (counter_.has_value()) {
-      // Racing update between await_ready() and await_suspend().
-      return false;
-    }
-    pending_ = handle;
-    return true;
+  void await_suspend(std::coroutine_handle<> handle) {
+    detents_.await_suspend(handle);
   }
 
   std::int64_t await_resume() {
-    CriticalSectionLock lock(mutex_);
-    const std::int64_t value = *counter_;
-    counter_.reset();
-    return value;
+    const auto batch = detents_.await_resume();
+    probe::Since(probe::Point::kDetent, probe::Histogram::kDetentToResume);
+    for (const Detent& detent : batch) {
+      UpdateRate(detent);
+    }
+    return batch.back().counter;
   }
 
-  void Send(std::int64_t counter) {
-    std::coroutine_handle<> pending;
-    {
-      CriticalSectionLock lock(mutex_);
-      if (counter_ == counter) {
-        return;
-      }
-      counter_ = counter;
-      std::swap(pending, pending_);
-    }
-    if (pending) {
-      executor_.Schedule(pending);
+  // Not thread-safe; called from the coroutine's async_context.
+  double Rate() const {
+    if (time_us_64() - last_time_us_ > kIdleUs) {
+      return 0;
     }
+    return rate_;
+  }
+
+  // Reports the counter as of `time_us`. Safe to call from interrupt handlers.
+  void Send(std::int64_t counter, std::uint64_t time_us) {
+    detents_.Push({.counter = counter, .time_us = time_us});
   }
 
  private:
-  AsyncExecutor executor_;
+  struct Detent {
+    std::int64_t counter;
+    std::uint64_t time_us;
+  };
+
+  // Smooths the speed over consecutive detents. The first detent after the
+  // encoder has been idle only starts the timing.
+  void UpdateRate(const Detent& detent) {
+    const std::uint64_t elapsed_us = detent.time_us - last_time_us_;
+    if (elapsed_us > kIdleUs) {
+      rate_ = 0;
+    } else if (elapsed_us > 0) {
+      const double rate = (detent.counter - last_counter_) * 1e6 / elapsed_us;
+      // Weight of the latest detent.
+      const double smoothing = 0.5;
+      rate_ += smoothing * (rate - rate_);
+    }
+    last_counter_ = detent.counter;
+    last_time_us_ = detent.time_us;
+  }
+
+  // Enough for a fast spin between two resumptions of the awaiting coroutine.
+  // The count is cumulative, so an overflow only loses timing information
+  // until the next detent.
+  EventQueue<Detent, 16> detents_;
 
-  CriticalSection mutex_;
-  std::optional<std::int64_t> counter_;
-  std::coroutine_handle<> pending_;
+  std::int64_t last_counter_ = 0;
+  std::uint64_t last_time_us_ = 0;
+  double rate_ = 0;
 };
 
 // Global state per encoder.
@@ -125,6 +163,33 @@ struct RotaryEncoder::State {
   void HandleInterrupt();
 };
 
+// Global state per PIO-decoded encoder.
+struct RotaryEncoder::PioState {
+  PIO pio;
+  unsigned sm;
+
+  // Quarter-step count of the state machine as of the last full detent.
+  std::uint32_t detent_position = 0;
+
+  // Signed cumulative full dedents measured.
+  std::int64_t counter = 0;
+
+  // When Poll() last ran, or zero before the first poll.
+  std::uint64_t last_poll_us = 0;
+
+  // Only nullopt to allow for default construction. This is populated before
+  // Init().
+  std::optional<Waiter> waiter;
+
+  AsyncScheduledWorker poller;
+
+  // Claims a state machine and starts decoding the given pins.
+  void Init(unsigned pin_a, unsigned pin_b);
+
+  // Reports any detents completed since the last poll.
+  void Poll();
+};
+
 template <unsigned pin_a, unsigned pin_b>
 RotaryEncoder RotaryEncoder::Create(async_context_t& context) {
   // Unique tag type for each pin pair.
@@ -136,9 +201,28 @@ RotaryEncoder RotaryEncoder::Create(async_context_t& context) {
   state.waiter.emplace(context);
   state.Init(Singleton::interrupt_handler);
 
-  return RotaryEncoder(&state);
+  return RotaryEncoder(*state.waiter);
+}
+
+template <unsigned pin_a, unsigned pin_b>
+RotaryEncoder RotaryEncoder::CreatePio(async_context_t& context) {
+  // Unique tag type for each pin pair.
+  using Tag = std::integer_sequence<unsigned, pin_a, pin_b>;
+  static PioState state;
+
+  state.waiter.emplace(context);
+  state.Init(pin_a, pin_b);
+  state.poller = AsyncScheduledWorker::Create<Tag>(context, [] {
+    state.Poll();
+    return make_timeout_time_us(kPollIntervalUs);
+  });
+  state.poller.ScheduleAt(get_absolute_time());
+
+  return RotaryEncoder(*state.waiter);
 }
 
 inline auto RotaryEncoder::operator co_await() {
-  return AwaitableReference(*state_->waiter);
+  return AwaitableReference(*waiter_);
 }
+
+inline double RotaryEncoder::Rate() const { return waiter_->Rate(); }
@@ -1,41 +1,48 @@
 #include "speed_control.h"
 
-#include <hardware/gpio.h>
-#include <hardware/pwm.h>
-
+#include <algorithm>
 #include <cmath>
-#include <iostream>
 #include <limits>
 
+#include "probe.h"
+#include "step_generator.pio.h"
+
 SpeedControl::SpeedControl(std::int64_t sys_clock_hz, unsigned pulse_pin,
                            unsigned dir_pin)
-    : sys_clock_hz_(sys_clock_hz), direction_(Gpio(dir_pin)) {
-  gpio_set_function(pulse_pin, GPIO_FUNC_PWM);
-
-  slice_ = pwm_gpio_to_slice_num(pulse_pin);
-  channel_ = pwm_gpio_to_channel(pulse_pin);
-
-  pwm_set_clkdiv(slice_, 125);
-  pwm_set_phase_correct(slice_, true);
+    : sys_clock_hz_(sys_clock_hz), direction_(Gpio(dir_pin)), pio_(pio0) {
+  const bool required = true;
+  sm_ = pio_claim_unused_sm(pio_, required);
+  const unsigned offset = pio_add_program(pio_, &step_generator_program);
+  step_generator_program_init(pio_, sm_, offset, pulse_pin);
 }
 
 void SpeedControl::Set(double freq_hz) {
-  pwm_set_enabled(slice_, false);
-  if (freq_hz == 0) {
-    std::cout << "requested speeed of 0; stopping." << std::endl;
+  // Exact for any rate that came from a Q32.32 value, as scaling by a power of
+  // two only changes the exponent.
+  const double magnitude = std::min(std::abs(freq_hz) * 0x1p32, 0x1p63);
+  Set(freq_hz < 0 ? -1 : 1, static_cast<Q32>(magnitude));
+}
+
+void SpeedControl::Set(int direction, Q32 freq_hz) {
+  probe::Since(probe::Point::kDetent, probe::Histogram::kDetentToStepRate);
+  // Drop any period that hasn't been picked up yet so that the new one is used
+  // at the next pulse boundary.
+  pio_sm_clear_fifos(pio_, sm_);
+  if (direction == 0 || freq_hz == 0) {
+    pio_sm_put(pio_, sm_, 0);
     return;
   }
-  direction_ = freq_hz > 0;
-  const double magnitude = std::abs(freq_hz);
-  // 1MHz base clock.
-  constexpr double max_wrap = std::numeric_limits<std::uint16_t>::max();
-  const std::uint16_t wrap = std::min(max_wrap, 1'000'000 / (2 * magnitude));
-  std::cout << "setting wrap to " << wrap
-            << "; requested frequency: " << freq_hz
-            << "; actual frequency will be : " << (1'000'000 / double(2 * wrap))
-            << std::endl;
-  pwm_set_wrap(slice_, wrap - 1);
-  pwm_set_chan_level(slice_, channel_, wrap / 2);
-  pwm_set_counter(slice_, 0);
-  pwm_set_enabled(slice_, true);
+  direction_ = direction > 0;
+  // Rounded to the nearest cycle. Fits in 64 bits as the clock is below 2^32.
+  const std::uint64_t period_cycles =
+      ((static_cast<std::uint64_t>(sys_clock_hz_) << kQ32FractionBits) +
+       freq_hz / 2) /
+      freq_hz;
+  const std::uint64_t half_period =
+      period_cycles > step_generator_overhead_cycles
+          ? (period_cycles - step_generator_overhead_cycles + 1) / 2
+          : 0;
+  pio_sm_put(pio_, sm_,
+             std::clamp<std::uint64_t>(
+                 half_period, 1, std::numeric_limits<std::uint32_t>::max()));
 }
@@ -1,19 +1,35 @@
 #pragma once
 
+#include <hardware/pio.h>
+
 #include <cstdint>
 
+#include "fixed_exp2.h"
 #include "picopp/gpio.h"
 
+// Step/direction pulse output for the feed motor. Pulses are generated by a PIO
+// state machine clocked at the system clock, so the period resolution is a
+// couple of system clock cycles, and speed changes take effect on the next
+// pulse boundary without dropping or truncating pulses.
 class SpeedControl {
  public:
+  // `sys_clock_hz` must be below 2^32.
   SpeedControl(std::int64_t sys_clock_hz, unsigned pulse_pin, unsigned dir_pin);
 
+  // Sets the step rate. The sign of `freq_hz` selects the direction; 0 stops
+  // the output after the pulse in flight. Cheap enough to call on every ramp
+  // tick.
   void Set(double freq_hz);
 
+  // Sets the step rate from an exact Q32.32 rate, with the period computed in
+  // integer arithmetic. The sign of `direction` selects the direction; 0, or a
+  // zero rate, stops the output as above.
+  void Set(int direction, Q32 freq_hz);
+
  private:
   const std::int64_t sys_clock_hz_;
   Gpio direction_;
 
-  unsigned slice_;
-  unsigned channel_;
+  PIO pio_;
+  unsigned sm_;
 };
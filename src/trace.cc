@@ -0,0 +1,97 @@
+#include "trace.h"
+
+#include <hardware/sync.h>
+#include <hardware/timer.h>
+#include <pico/platform.h>
+
+#include <atomic>
+#include <string_view>
+
+#include "picoro/spsc_ring.h"
+
+namespace trace {
+namespace {
+
+constexpr std::size_t kRecordsPerCore = 64;
+constexpr unsigned kNumCores = 2;
+
+// Each core only writes its own ring, with interrupts disabled so that
+// handlers can't interleave with the code they interrupted. That leaves a
+// single producer per ring and no lock between the cores.
+struct CoreLog {
+  SpscRing<Record, kRecordsPerCore> ring;
+  // Only written by the owning core.
+  std::atomic<std::uint32_t> dropped = 0;
+  // Only accessed by Print().
+  std::uint32_t reported_dropped = 0;
+};
+
+std::array<CoreLog, kNumCores> core_logs;
+
+void PrintArg(std::ostream& out, const Arg& arg) {
+  switch (arg.kind) {
+    case Arg::Kind::kInt:
+      out << arg.i;
+      break;
+    case Arg::Kind::kUint:
+      out << arg.u;
+      break;
+    case Arg::Kind::kDouble:
+      out << arg.d;
+      break;
+    case Arg::Kind::kString:
+      out << arg.s;
+      break;
+  }
+}
+
+void PrintRecord(std::ostream& out, const Record& record) {
+  out << record.time_us / 1000 << "ms: ";
+  const std::string_view format = record.format;
+  std::size_t next_arg = 0;
+  for (std::size_t i = 0; i < format.size(); ++i) {
+    if (format.substr(i, 2) == "{}" && next_arg < record.arg_count) {
+      PrintArg(out, record.args[next_arg++]);
+      ++i;
+    } else {
+      out << format[i];
+    }
+  }
+  out << '\n';
+}
+
+}  // namespace
+
+void Write(Record record) {
+  CoreLog& log = core_logs[get_core_num()];
+  const std::uint32_t interrupts = save_and_disable_interrupts();
+  // Stamped here so that an interrupt logging in between can't push a later
+  // record ahead of this one, and timestamps within a core stay in order.
+  record.time_us = time_us_64();
+  if (!log.ring.Push(record)) {
+    log.dropped.store(log.dropped.load(std::memory_order_relaxed) + 1,
+                      std::memory_order_relaxed);
+  }
+  restore_interrupts(interrupts);
+}
+
+std::size_t Print(std::ostream& out) {
+  std::size_t printed = 0;
+  for (unsigned core = 0; core < kNumCores; ++core) {
+    CoreLog& log = core_logs[core];
+    Record record;
+    while (log.ring.Pop(record)) {
+      PrintRecord(out, record);
+      ++printed;
+    }
+    const std::uint32_t dropped = log.dropped.load(std::memory_order_relaxed);
+    if (dropped != log.reported_dropped) {
+      out << "(" << dropped - log.reported_dropped
+          << " trace records dropped on core " << core << ")\n";
+      log.reported_dropped = dropped;
+    }
+  }
+  return printed;
+}
+
+}  // namespace trace
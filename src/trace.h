@@ -0,0 +1,71 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <type_traits>
+
+// Deferred logging. Log() copies a format string pointer, a timestamp and a
+// few scalar arguments into a fixed-size ring for the current core, which
+// takes well under a microsecond and never blocks: when the ring is full the
+// record is dropped and counted. Formatting and output happen later, in
+// Print(), typically from a low priority task.
+namespace trace {
+
+inline constexpr std::size_t kMaxArgs = 4;
+
+struct Arg {
+  enum class Kind : std::uint8_t { kInt, kUint, kDouble, kString };
+
+  Kind kind;
+  union {
+    std::int64_t i;
+    std::uint64_t u;
+    double d;
+    const char* s;
+  };
+};
+
+struct Record {
+  // Static string in which each `{}` is replaced by the next argument.
+  const char* format;
+  std::uint64_t time_us;
+  std::uint8_t arg_count;
+  std::array<Arg, kMaxArgs> args;
+};
+
+template <typename T>
+Arg MakeArg(T value) {
+  if constexpr (std::is_floating_point_v<T>) {
+    return {.kind = Arg::Kind::kDouble, .d = value};
+  } else if constexpr (std::is_convertible_v<T, const char*>) {
+    return {.kind = Arg::Kind::kString, .s = value};
+  } else if constexpr (std::is_signed_v<T>) {
+    return {.kind = Arg::Kind::kInt, .i = value};
+  } else {
+    static_assert(std::is_unsigned_v<T>, "Unsupported trace argument type");
+    return {.kind = Arg::Kind::kUint, .u = value};
+  }
+}
+
+// Timestamps and queues `record`. Safe to call from any core and from
+// interrupt handlers.
+void Write(Record record);
+
+// Records a message for later printing. `format` and any string arguments must
+// be string literals, or otherwise outlive the record.
+template <typename... Args>
+void Log(const char* format, Args... args) {
+  static_assert(sizeof...(Args) <= kMaxArgs, "Too many trace arguments");
+  Write({.format = format,
+         .arg_count = sizeof...(Args),
+         .args = {MakeArg(args)...}});
+}
+
+// Formats and writes all queued records to `out`, one per line, along with a
+// count of any dropped since the last call. Returns the number of records
+// printed. Must not be called concurrently with itself.
+std::size_t Print(std::ostream& out);
+
+}  // namespace trace